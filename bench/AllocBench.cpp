@@ -0,0 +1,40 @@
+#include "Bench.hpp"
+#include "../src/Terrain/TerrainMesh.hpp"
+#include "../src/Terrain/Arena.hpp"
+#include "../src/Util/AllocCounter.hpp"
+#include <iostream>
+
+void benchAllocations(int size)
+{
+	if(!AllocCounter::enabled())
+		std::cout << "(configure with -DITT_COUNT_ALLOCATIONS=ON to get allocation counts)" << std::endl;
+
+	TerrainMeshBuilder builder(size, size);
+
+	{
+		AllocCounter::Scope scope("legacy quads");
+		BenchTimer timer;
+		TerrainMesh mesh = buildLegacyTerrainMesh(size, size);
+		std::cout << "legacy quads: " << timer.elapsedMs() << " ms" << std::endl;
+	}
+
+	{
+		AllocCounter::Scope scope("vector build");
+		BenchTimer timer;
+		TerrainMesh mesh = builder.build();
+		std::cout << "vector build: " << timer.elapsedMs() << " ms" << std::endl;
+	}
+
+	// Start undersized so the first build has to grow, then rebuild after reset
+	Arena arena(builder.arenaBytes() / 4);
+	for(int pass = 0; pass < 3; pass++)
+	{
+		arena.reset();
+
+		AllocCounter::Scope scope(pass == 0 ? "arena build (cold)" : "arena rebuild");
+		BenchTimer timer;
+		builder.build(arena);
+		std::cout << "arena pass " << pass << ": " << timer.elapsedMs() << " ms, "
+				  << arena.blocks.size() << " block(s)" << std::endl;
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+struct HeightGrid;
+
+// Wall-clock stopwatch for the headless benchmarks
+struct BenchTimer
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	double elapsedMs() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+};
+
+inline double toMiB(size_t bytes)
+{
+	return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+// Square heightmap of hills cut off into flat plateaus and valleys
+HeightGrid plateauHeightGrid(int size);
+
+// Each benchmark takes the heightmap edge length to test with
+void benchMeshBuild(int size);
+void benchAllocations(int size);
+void benchThreadScaling(int size);
+void benchKernels(int size);
+void benchLayouts(int size);
+void benchTiles(int size);
+void benchStrips(int size);
+void benchVertexCache(int size);
+void benchMeshlets(int size);
+void benchRtin(int size);
+void benchGreedyTin(int size);
+void benchDecimation(int size);
+void benchChunkedLod(int size);
+void benchCdlod(int size);
+void benchClipmap(int size);
+void benchRoam(int size);
+void benchSeams(int size);
+void benchLodScheduler(int size);
+void benchRawMap(int size);
+void benchTiledHeightfield(int size);
+void benchMeshCache(int size);
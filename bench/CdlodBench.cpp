@@ -0,0 +1,59 @@
+#include "Bench.hpp"
+#include "../src/Terrain/Cdlod.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include <iostream>
+#include <vector>
+
+void benchCdlod(int size)
+{
+	HeightGrid heights = plateauHeightGrid(size);
+
+	Cdlod cdlod;
+	cdlod.threadCount = defaultThreadCount();
+
+	BenchTimer buildTimer;
+	cdlod.build(heights);
+	double buildMs = buildTimer.elapsedMs();
+
+	size_t patchVertices = static_cast<size_t>(cdlod.patchCells + 1) * static_cast<size_t>(cdlod.patchCells + 1);
+	size_t patchTriangles = 2 * static_cast<size_t>(cdlod.patchCells) * static_cast<size_t>(cdlod.patchCells);
+	std::cout << "quadtree: " << cdlod.nodes.size() << " nodes in " << cdlod.levelCount << " levels, "
+			  << toMiB(cdlod.nodes.size() * sizeof(CdlodNode)) << " MiB, built in " << buildMs << " ms" << std::endl;
+	std::cout << "patch: " << cdlod.patchCells << "x" << cdlod.patchCells << " cells, "
+			  << patchVertices * 4 << " bytes of vertices, shared by every instance" << std::endl;
+
+	// Same camera positions as the chunked LOD benchmark
+	float scale = size * 0.1f;
+	float s = static_cast<float>(size);
+	const struct { const char* name; float position[3]; } cameras[] =
+	{
+		{ "viewer start", { s * 0.5f, s / 6.0f, s * 1.7f } },
+		{ "low, centre", { s * 0.5f, scale * 0.8f, s * 0.5f } },
+		{ "low, corner", { 0.0f, scale * 0.8f, 0.0f } },
+		{ "high above", { s * 0.5f, s * 2.0f, s * 0.5f } },
+		{ "far away", { s * 0.5f, s / 6.0f, s * 8.0f } },
+	};
+
+	// Selection only, drawing is a single instanced call per frame
+	double gridTriangles = 2.0 * size * size;
+	std::vector<CdlodInstance> instances;
+	for(const auto& camera : cameras)
+	{
+		LodCamera lodCamera;
+		lodCamera.position[0] = camera.position[0];
+		lodCamera.position[1] = camera.position[1];
+		lodCamera.position[2] = camera.position[2];
+		lodCamera.heightScale = scale;
+
+		const int repeats = 200;
+		BenchTimer selectTimer;
+		for(int r = 0; r < repeats; r++)
+			cdlod.select(lodCamera, instances);
+		double selectUs = selectTimer.elapsedMs() * 1000.0 / repeats;
+
+		size_t triangles = instances.size() * patchTriangles;
+		std::cout << "  " << camera.name << ": " << instances.size() << " instances ("
+				  << instances.size() * sizeof(CdlodInstance) << " bytes), " << triangles << " triangles ("
+				  << 100.0 * triangles / gridTriangles << "% of the grid), selected in " << selectUs << " us" << std::endl;
+	}
+}
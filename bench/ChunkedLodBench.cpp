@@ -0,0 +1,110 @@
+#include "Bench.hpp"
+#include "../src/Terrain/ChunkedLod.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include <iostream>
+#include <vector>
+
+struct CameraPosition
+{
+	const char* name;
+	float position[3];
+};
+
+void benchChunkedLod(int size)
+{
+	HeightGrid heights = plateauHeightGrid(size);
+
+	ChunkedLod lod;
+	lod.threadCount = defaultThreadCount();
+
+	BenchTimer buildTimer;
+	lod.build(heights);
+	double buildMs = buildTimer.elapsedMs();
+
+	std::cout << "quadtree: " << lod.chunks.size() << " chunks of " << lod.chunkCells << "x" << lod.chunkCells
+			  << " cells in " << lod.levelCount << " levels, root error " << lod.chunks[0].geometricError
+			  << ", built in " << buildMs << " ms" << std::endl;
+
+	TerrainTiler tiler(size, size);
+	tiler.grid.threadCount = defaultThreadCount();
+	Arena arena(chunkedArenaBytes<SoALayout>(tiler, lod));
+
+	BenchTimer meshTimer;
+	TiledMeshView<SoALayout> mesh = buildChunkedMesh<SoALayout>(tiler, lod, arena);
+	double meshMs = meshTimer.elapsedMs();
+
+	std::cout << "chunk buffers: " << mesh.vertexCount << " vertices, " << toMiB(mesh.byteSize()) << " MiB, built in "
+			  << meshMs << " ms" << std::endl;
+
+	// The same buffers with each vertex's height on the parent's surface
+	ChunkedLod morphedLod = lod;
+	morphedLod.geomorph = true;
+	tiler.grid.heights = &heights;
+	Arena morphArena(chunkedArenaBytes<SoALayout>(tiler, morphedLod));
+
+	BenchTimer morphTimer;
+	TiledMeshView<SoALayout> morphed = buildChunkedMesh<SoALayout>(tiler, morphedLod, morphArena);
+	double morphMs = morphTimer.elapsedMs();
+
+	// Corners that the parent has too must keep their height
+	bool targetsMatch = true;
+	for(size_t c = 1; c < lod.chunks.size() && targetsMatch; c++)
+	{
+		const LodChunk& chunk = lod.chunks[c];
+		for(int a = 0; a <= chunk.rows; a += 2)
+		for(int b = 0; b <= chunk.columns; b += 2)
+			targetsMatch &= lod.morphTarget(chunk, heights, a, b) == heights.cornerHeight(chunk.gridRow(a), chunk.gridColumn(b));
+	}
+
+	std::cout << "with morph targets: " << toMiB(morphed.morphTargets.bytes()) << " MiB more, built in " << morphMs
+			  << " ms" << (targetsMatch ? "" : ", PARENT CORNERS MOVE") << std::endl;
+
+	// Heights scaled like a steep version of the viewer's terrain
+	float scale = size * 0.1f;
+	float s = static_cast<float>(size);
+	const CameraPosition cameras[] =
+	{
+		{ "viewer start", { s * 0.5f, s / 6.0f, s * 1.7f } },
+		{ "low, centre", { s * 0.5f, scale * 0.8f, s * 0.5f } },
+		{ "low, corner", { 0.0f, scale * 0.8f, 0.0f } },
+		{ "high above", { s * 0.5f, s * 2.0f, s * 0.5f } },
+		{ "far away", { s * 0.5f, s / 6.0f, s * 8.0f } },
+	};
+
+	double gridTriangles = 2.0 * size * size;
+	const float pixelErrors[] = { 1.0f, 4.0f };
+	std::vector<uint32_t> selected;
+	std::vector<float> morphs;
+	for(float pixelError : pixelErrors)
+	for(const CameraPosition& camera : cameras)
+	{
+		LodCamera lodCamera;
+		lodCamera.position[0] = camera.position[0];
+		lodCamera.position[1] = camera.position[1];
+		lodCamera.position[2] = camera.position[2];
+		lodCamera.heightScale = scale;
+
+		const int repeats = 200;
+		BenchTimer selectTimer;
+		for(int r = 0; r < repeats; r++)
+			lod.select(lodCamera, pixelError, selected);
+		double selectUs = selectTimer.elapsedMs() * 1000.0 / repeats;
+
+		BenchTimer morphFactorTimer;
+		for(int r = 0; r < repeats; r++)
+			lod.morphFactors(lodCamera, pixelError, selected, morphs);
+		double morphUs = morphFactorTimer.elapsedMs() * 1000.0 / repeats;
+
+		size_t triangles = 0, cells = 0;
+		for(uint32_t c : selected)
+		{
+			const LodChunk& chunk = lod.chunks[c];
+			triangles += 2 * static_cast<size_t>(chunk.rows) * static_cast<size_t>(chunk.columns);
+			cells += static_cast<size_t>(chunk.lastRow - chunk.firstRow) * static_cast<size_t>(chunk.lastColumn - chunk.firstColumn);
+		}
+
+		std::cout << "  " << pixelError << " px, " << camera.name << ": " << selected.size() << " chunks, " << triangles
+				  << " triangles (" << 100.0 * triangles / gridTriangles << "% of the grid), selected in " << selectUs
+				  << " us, morphs in " << morphUs << " us" << (cells == static_cast<size_t>(size) * size ? "" : ", DOESN'T COVER THE GRID") << std::endl;
+	}
+}
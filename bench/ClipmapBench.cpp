@@ -0,0 +1,78 @@
+#include "Bench.hpp"
+#include "../src/Terrain/GeometryClipmap.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include <algorithm>
+#include <iostream>
+
+struct ClipmapFlight
+{
+	size_t fillBytes = 0;
+	double fillMs = 0.0;
+	size_t totalBytes = 0;
+	size_t maxBytes = 0;
+	double frameUs = 0.0;
+	bool valid = false;
+};
+
+static const int clipmapFrames = 600;
+
+// A straight flight at a few cells per frame, from the same place on every map
+static ClipmapFlight flyClipmap(GeometryClipmap& clipmap, const HeightGrid& heights, float row, float column)
+{
+	ClipmapFlight flight;
+	clipmap.build(heights);
+
+	BenchTimer fillTimer;
+	clipmap.update(row, column);
+	flight.fillMs = fillTimer.elapsedMs();
+	flight.fillBytes = clipmap.bytesUpdated;
+
+	BenchTimer flightTimer;
+	for(int frame = 0; frame < clipmapFrames; frame++)
+	{
+		row += 1.7f;
+		column += 0.9f;
+		clipmap.update(row, column);
+		flight.totalBytes += clipmap.bytesUpdated;
+		flight.maxBytes = std::max(flight.maxBytes, clipmap.bytesUpdated);
+	}
+	flight.frameUs = flightTimer.elapsedMs() * 1000.0 / clipmapFrames;
+	flight.valid = validateClipmap(clipmap, heights);
+	return flight;
+}
+
+void benchClipmap(int size)
+{
+	// The same flight over maps of increasing size costs the same with the
+	// same levels. Left to build(), each doubling of the map adds a coarser
+	// level whose strips add to the bytes per frame.
+	const int mapSizes[] = { std::max(size / 4, 1), std::max(size / 2, 1), size };
+	float row = mapSizes[0] * 0.1f, column = mapSizes[0] * 0.2f;
+
+	GeometryClipmap clipmap;
+	int fixedLevels = clipmap.levelsToCover(size, size);
+	size_t firstBytes = 0;
+	bool bytesMatch = true;
+	for(int mapSize : mapSizes)
+	{
+		HeightGrid heights = plateauHeightGrid(mapSize);
+
+		clipmap.levelCount = fixedLevels;
+		ClipmapFlight fixed = flyClipmap(clipmap, heights, row, column);
+		if(mapSize == mapSizes[0])
+			firstBytes = fixed.totalBytes;
+		bytesMatch = bytesMatch && fixed.totalBytes == firstBytes;
+
+		clipmap.levelCount = 0;
+		ClipmapFlight covering = flyClipmap(clipmap, heights, row, column);
+
+		std::cout << mapSize << "x" << mapSize << ": " << fixedLevels << " levels of " << clipmap.samples() << "^2 samples, "
+				  << "first fill " << fixed.fillBytes / 1024 << " KiB in " << fixed.fillMs << " ms, flight "
+				  << fixed.totalBytes / clipmapFrames << " bytes/frame on average, " << fixed.maxBytes << " at most, "
+				  << fixed.frameUs << " us/frame; with build()'s " << clipmap.levels.size() << " levels "
+				  << covering.totalBytes / clipmapFrames << " bytes/frame"
+				  << (fixed.valid && covering.valid ? "" : ", SAMPLES DON'T MATCH THE GRID") << std::endl;
+	}
+	std::cout << (bytesMatch ? "bytes per frame match across map sizes at " : "BYTES PER FRAME DIFFER across map sizes at ")
+			  << fixedLevels << " levels" << std::endl;
+}
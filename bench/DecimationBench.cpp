@@ -0,0 +1,60 @@
+#include "Bench.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/QuadricDecimator.hpp"
+#include "../src/Util/Parallel.hpp"
+#include <iostream>
+#include <vector>
+
+void benchDecimation(int size)
+{
+	HeightGrid heights = plateauHeightGrid(size);
+
+	// One mesh with 32-bit indices
+	TerrainMeshBuilder builder(size, size);
+	TerrainMesh mesh = builder.build();
+	heights.displace(mesh.positions.data(), mesh.vertexCount(), 10.0f);
+
+	const float ratios[] = { 0.5f, 0.1f };
+	for(float ratio : ratios)
+	{
+		std::vector<unsigned int> indices = mesh.indices;
+		QuadricDecimator decimator;
+		decimator.targetRatio = ratio;
+
+		BenchTimer timer;
+		size_t indexCount = decimator.decimate(mesh.positions.data(), mesh.vertexCount(), indices.data(), indices.size(),
+											   static_cast<size_t>(indices.size() / 3 * ratio));
+		double ms = timer.elapsedMs();
+
+		std::cout << "whole mesh, ratio " << ratio << ": " << mesh.indices.size() / 3 << " -> " << indexCount / 3
+				  << " triangles in " << ms << " ms" << std::endl;
+	}
+
+	// Tiles, with locked seams
+	TerrainTiler tiler(size, size);
+	Arena arena(tiledArenaBytes<SoALayout>(tiler));
+	TiledMeshView<SoALayout> tiled = buildTiledMesh<SoALayout>(tiler, arena);
+
+	const float* gridPositions = reinterpret_cast<const float*>(tiled.buffers[0].data);
+	std::vector<float> positions(gridPositions, gridPositions + tiled.vertexCount * 3);
+	heights.displace(positions.data(), tiled.vertexCount, 10.0f);
+
+	const unsigned threadCounts[] = { 1, defaultThreadCount() };
+	for(unsigned threads : threadCounts)
+	for(float ratio : ratios)
+	{
+		std::vector<uint16_t> indices(tiled.indices.begin(), tiled.indices.end());
+		std::vector<TerrainTile> tiles(tiled.tiles.begin(), tiled.tiles.end());
+
+		QuadricDecimator decimator;
+		decimator.targetRatio = ratio;
+		decimator.threadCount = threads;
+
+		BenchTimer timer;
+		size_t indexCount = decimator.decimateTiles(positions.data(), indices.data(), tiles.data(), tiles.size());
+		double ms = timer.elapsedMs();
+
+		std::cout << tiles.size() << " tiles, " << threads << " threads, ratio " << ratio << ": " << tiled.indices.size / 3
+				  << " -> " << indexCount / 3 << " triangles in " << ms << " ms" << std::endl;
+	}
+}
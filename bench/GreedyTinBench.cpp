@@ -0,0 +1,43 @@
+#include "Bench.hpp"
+#include "../src/Terrain/GreedyTin.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/Rtin.hpp"
+#include <iostream>
+
+void benchGreedyTin(int size)
+{
+	HeightGrid heights = plateauHeightGrid(size);
+	double gridTriangles = 2.0 * size * size;
+
+	// Error targets, next to RTIN's triangle count for the same error when it applies
+	const float maxErrors[] = { 0.05f, 0.02f, 0.01f, 0.005f, 0.002f };
+	for(float maxError : maxErrors)
+	{
+		BenchTimer timer;
+		GreedyTin tin(heights);
+		tin.run(maxError);
+		double ms = timer.elapsedMs();
+
+		std::cout << "max error " << maxError << ": " << tin.triangleCount() << " triangles ("
+				  << 100.0 * tin.triangleCount() / gridTriangles << "% of the grid) in " << ms << " ms";
+		if(Rtin::supports(size, size))
+		{
+			Rtin rtin(heights);
+			std::cout << ", RTIN needs " << rtin.extract(maxError).triangleCount();
+		}
+		std::cout << std::endl;
+	}
+
+	// Triangle budgets
+	const size_t budgets[] = { 1000, 10000, 100000 };
+	for(size_t budget : budgets)
+	{
+		BenchTimer timer;
+		GreedyTin tin(heights);
+		tin.run(0.0f, budget);
+		double ms = timer.elapsedMs();
+
+		std::cout << "budget " << budget << ": max error " << tin.maxError() << " with "
+				  << tin.triangleCount() << " triangles in " << ms << " ms" << std::endl;
+	}
+}
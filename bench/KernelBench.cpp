@@ -0,0 +1,48 @@
+#include "Bench.hpp"
+#include "../src/Terrain/TerrainMesh.hpp"
+#include "../src/Terrain/Arena.hpp"
+#include <cstring>
+#include <iostream>
+
+void benchKernels(int size)
+{
+	TerrainMeshBuilder builder(size, size);
+	builder.simdLevel = SimdLevel::Scalar;
+
+	Arena referenceArena(builder.arenaBytes());
+	TerrainMeshView reference = builder.build(referenceArena);
+
+	Arena arena(builder.arenaBytes());
+	const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 };
+	for(SimdLevel level : levels)
+	{
+		if(!isSimdLevelSupported(level))
+		{
+			std::cout << simdLevelName(level) << ": not supported" << std::endl;
+			continue;
+		}
+
+		builder.simdLevel = level;
+
+		// Best of a few runs, after one to fault the arena pages in
+		double bestMs = 0.0;
+		TerrainMeshView mesh;
+		for(int run = 0; run < 4; run++)
+		{
+			arena.reset();
+			BenchTimer timer;
+			mesh = builder.build(arena);
+			double ms = timer.elapsedMs();
+			if(run == 1 || (run > 1 && ms < bestMs))
+				bestMs = ms;
+		}
+
+		bool identical = std::memcmp(reference.positions.data, mesh.positions.data, mesh.positions.bytes()) == 0 &&
+						 std::memcmp(reference.texCoords.data, mesh.texCoords.data, mesh.texCoords.bytes()) == 0 &&
+						 std::memcmp(reference.indices.data, mesh.indices.data, mesh.indices.bytes()) == 0;
+
+		double gbPerSecond = static_cast<double>(mesh.byteSize()) / (bestMs * 1.0e6);
+		std::cout << simdLevelName(level) << ": " << bestMs << " ms, " << gbPerSecond << " GB/s"
+				  << (identical ? ", identical" : ", MISMATCH") << std::endl;
+	}
+}
@@ -0,0 +1,72 @@
+#include "Bench.hpp"
+#include "../src/Terrain/VertexLayout.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include <cmath>
+#include <iostream>
+
+// Walks the index buffer and reads every attribute of every referenced
+// vertex, the way the vertex fetch stage would
+template<typename Layout>
+static unsigned int fetchAll(const LayoutMeshView<Layout>& mesh)
+{
+	auto attributes = Layout::attributes();
+	unsigned int sum = 0;
+	for(unsigned int index : mesh.indices)
+	for(const VertexAttribute& attribute : attributes)
+	{
+		const unsigned char* src = mesh.buffers[attribute.buffer].data + index * attribute.stride + attribute.offset;
+		size_t bytes = attribute.components * attributeTypeSize(attribute.type);
+		for(size_t b = 0; b < bytes; b++)
+			sum += src[b];
+	}
+	return sum;
+}
+
+template<typename Layout>
+static void benchLayout(const char* name, const TerrainMeshBuilder& builder)
+{
+	if(!Layout::fitsGrid(builder.width, builder.height))
+	{
+		std::cout << name << ": grid positions can't reach " << builder.width << "x" << builder.height << std::endl;
+		return;
+	}
+
+	Arena arena(layoutArenaBytes<Layout>(builder));
+
+	// Fault the arena pages in before timing
+	buildLayoutMesh<Layout>(builder, arena);
+	arena.reset();
+
+	BenchTimer buildTimer;
+	LayoutMeshView<Layout> mesh = buildLayoutMesh<Layout>(builder, arena);
+	double buildMs = buildTimer.elapsedMs();
+
+	BenchTimer fetchTimer;
+	volatile unsigned int sink = fetchAll(mesh);
+	(void)sink;
+	double fetchMs = fetchTimer.elapsedMs();
+
+	size_t vertexBytes = mesh.byteSize() - mesh.indices.bytes();
+	std::cout << name << ": " << vertexBytes / mesh.vertexCount << " B/vertex, "
+			  << toMiB(mesh.byteSize()) << " MiB, build " << buildMs
+			  << " ms, indexed fetch " << fetchMs << " ms" << std::endl;
+}
+
+void benchLayouts(int size)
+{
+	// Synthetic rolling hills for the baked height format
+	HeightGrid heights(size, size);
+	for(int z = 0; z < size; z++)
+	for(int x = 0; x < size; x++)
+		heights.texels[static_cast<size_t>(z) * size + x] = 0.5f + 0.25f * std::sin(x * 0.05f) * std::cos(z * 0.03f);
+
+	TerrainMeshBuilder builder(size, size);
+	builder.heights = &heights;
+
+	benchLayout<SoALayout>("SoA          ", builder);
+	benchLayout<AoSLayout>("AoS          ", builder);
+	benchLayout<PositionOnlyLayout>("position only", builder);
+	benchLayout<QuantizedLayout>("quantized    ", builder);
+	benchLayout<GridOnlyLayout>("grid only    ", builder);
+	benchLayout<BakedHeightLayout>("baked height ", builder);
+}
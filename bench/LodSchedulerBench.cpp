@@ -0,0 +1,139 @@
+#include "Bench.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/LodScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// The selected chunks' cells add up to the grid's only if they cover it once
+static bool coversGrid(const ChunkedLod& lod, const std::vector<uint32_t>& selected)
+{
+	size_t cells = 0;
+	for(uint32_t c : selected)
+	{
+		const LodChunk& chunk = lod.chunks[c];
+		cells += static_cast<size_t>(chunk.lastRow - chunk.firstRow) * static_cast<size_t>(chunk.lastColumn - chunk.firstColumn);
+	}
+	return cells == static_cast<size_t>(lod.width) * static_cast<size_t>(lod.height);
+}
+
+void benchLodScheduler(int size)
+{
+	HeightGrid heights = plateauHeightGrid(size);
+
+	// Small chunks, so there are thousands of them to schedule
+	ChunkedLod lod;
+	lod.chunkCells = 32;
+	lod.threadCount = defaultThreadCount();
+	lod.build(heights);
+	std::cout << "quadtree: " << lod.chunks.size() << " chunks of " << lod.chunkCells << "x" << lod.chunkCells
+			  << " cells in " << lod.levelCount << " levels" << std::endl;
+
+	// A low flight over the map and back, like the roam bench's
+	const int frames = 400;
+	float scale = size * 0.1f;
+	float s = static_cast<float>(size);
+	std::vector<LodCamera> path(frames);
+	for(int frame = 0; frame < frames; frame++)
+	{
+		float t = static_cast<float>(frame) / frames;
+		path[frame].position[0] = s * (0.1f + 0.8f * t);
+		path[frame].position[1] = scale * (1.0f + 0.5f * std::sin(t * 6.2831853f));
+		path[frame].position[2] = s * (0.5f + 0.3f * std::sin(t * 12.566371f));
+		path[frame].heightScale = scale;
+	}
+
+	// What a fixed pixel error costs along the same path, for comparison
+	std::vector<uint32_t> selected;
+	const float pixelErrors[] = { 1.0f, 4.0f };
+	for(float pixelError : pixelErrors)
+	{
+		size_t totalTriangles = 0, maxTriangles = 0;
+		for(const LodCamera& camera : path)
+		{
+			lod.select(camera, pixelError, selected);
+			size_t triangles = 0;
+			for(uint32_t c : selected)
+				triangles += lod.chunkTriangleCount(lod.chunks[c]);
+			totalTriangles += triangles;
+			maxTriangles = std::max(maxTriangles, triangles);
+		}
+		std::cout << "  fixed " << pixelError << " px: " << totalTriangles / frames << " triangles per frame, "
+				  << maxTriangles << " at most" << std::endl;
+	}
+
+	// With stitching, restrictSelection() must find nothing left to split
+	LodScheduler scheduler;
+	std::vector<uint32_t> restricted;
+	std::vector<uint8_t> seamMasks;
+	std::vector<float> morphs;
+	const SeamMode seamModes[] = { SeamMode::None, SeamMode::Stitching };
+	const LodBudget kinds[] = { LodBudget::Triangles, LodBudget::Vertices };
+	const size_t budgets[] = { 65536, 262144, 1048576 };
+	for(SeamMode seams : seamModes)
+	for(LodBudget kind : kinds)
+	for(size_t budget : budgets)
+	{
+		lod.seams = seams;
+		scheduler.budgetKind = kind;
+		scheduler.budget = budget;
+
+		size_t totalTriangles = 0, totalVertices = 0, totalChunks = 0, totalForced = 0, unboundedFrames = 0, blending = 0;
+		double totalError = 0.0, totalMaxError = 0.0, totalMs = 0.0, maxMs = 0.0;
+		float worstError = 0.0f;
+		bool withinBudget = true, covers = true, restrictedAlready = true;
+		for(const LodCamera& camera : path)
+		{
+			BenchTimer timer;
+			LodScheduleStats stats = scheduler.schedule(lod, camera, selected);
+			double ms = timer.elapsedMs();
+
+			size_t spent = kind == LodBudget::Triangles ? stats.triangles : stats.vertices;
+			withinBudget &= spent <= budget || stats.overBudget;
+			covers &= coversGrid(lod, selected);
+			if(seams == SeamMode::Stitching)
+			{
+				restricted = selected;
+				lod.restrictSelection(restricted, seamMasks);
+				restrictedAlready &= restricted.size() == selected.size();
+			}
+
+			totalForced += stats.forcedRefinements;
+			unboundedFrames += stats.unboundedError ? 1 : 0;
+
+			// Chunks that blend at the error the budget reached
+			if(stats.pixelErrorReached > 0.0f)
+			{
+				lod.morphFactors(camera, stats.pixelErrorReached, selected, morphs);
+				blending += static_cast<size_t>(std::count_if(morphs.begin(), morphs.end(), [](float m) { return m > 0.0f; }));
+			}
+
+			totalTriangles += stats.triangles;
+			totalVertices += stats.vertices;
+			totalChunks += selected.size();
+			if(!stats.unboundedError)
+			{
+				totalError += stats.meanPixelError;
+				totalMaxError += stats.maxPixelError;
+				worstError = std::max(worstError, stats.maxPixelError);
+			}
+			totalMs += ms;
+			maxMs = std::max(maxMs, ms);
+		}
+
+		// Frames with an unrefined chunk around the camera are counted instead
+		size_t boundedFrames = std::max<size_t>(frames - unboundedFrames, 1);
+		std::cout << "  " << (seams == SeamMode::Stitching ? "stitched " : "") << budget << (kind == LodBudget::Triangles ? " triangles: " : " vertices: ") << totalChunks / frames
+				  << " chunks, " << totalTriangles / frames << " triangles, " << totalVertices / frames
+				  << " vertices, mean error " << totalError / boundedFrames << " px, worst chunk " << totalMaxError / boundedFrames
+				  << " px (" << worstError << " at most), scheduled in " << totalMs / frames << " ms (" << maxMs
+				  << " at most), " << blending / frames << " chunks blending";
+		if(unboundedFrames > 0)
+			std::cout << ", " << unboundedFrames << " FRAMES WITH AN UNREFINED CHUNK AROUND THE CAMERA, left out of the errors";
+		if(seams == SeamMode::Stitching)
+			std::cout << ", " << totalForced / frames << " forced refinements" << (restrictedAlready ? "" : ", RESTRICTION SPLIT MORE");
+		std::cout << (withinBudget ? "" : ", OVER BUDGET") << (covers ? "" : ", DOESN'T COVER THE GRID")
+				  << std::endl;
+	}
+}
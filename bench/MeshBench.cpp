@@ -0,0 +1,38 @@
+#include "Bench.hpp"
+#include "../src/Terrain/TerrainMesh.hpp"
+#include <iostream>
+
+static void report(const char* label, const TerrainMesh& mesh, double ms)
+{
+	std::cout << label << ": " << mesh.vertexCount() << " vertices, "
+			  << mesh.indices.size() / 3 << " triangles, "
+			  << toMiB(mesh.byteSize()) << " MiB, " << ms << " ms" << std::endl;
+}
+
+void benchMeshBuild(int size)
+{
+	BenchTimer legacyTimer;
+	TerrainMesh legacy = buildLegacyTerrainMesh(size, size);
+	report("legacy quads", legacy, legacyTimer.elapsedMs());
+
+	BenchTimer sharedTimer;
+	TerrainMesh shared = TerrainMeshBuilder(size, size).build();
+	report("shared grid ", shared, sharedTimer.elapsedMs());
+
+	// Both generators walk the cells in the same order, so triangle t must
+	// have identical corners in each mesh
+	size_t mismatches = 0;
+	for(size_t k = 0; k < shared.indices.size(); k++)
+	{
+		unsigned int a = legacy.indices[k];
+		unsigned int b = shared.indices[k];
+		for(int c = 0; c < 3; c++)
+			if(legacy.positions[a * 3 + c] != shared.positions[b * 3 + c])
+				mismatches++;
+		for(int c = 0; c < 2; c++)
+			if(legacy.texCoords[a * 2 + c] != shared.texCoords[b * 2 + c])
+				mismatches++;
+	}
+	std::cout << "surface mismatches: " << mismatches << std::endl;
+	std::cout << "memory ratio: " << static_cast<double>(legacy.byteSize()) / shared.byteSize() << "x" << std::endl;
+}
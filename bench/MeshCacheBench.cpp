@@ -0,0 +1,88 @@
+#include "Bench.hpp"
+#include "../src/Terrain/Arena.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/MeshCache.hpp"
+#include "../src/Util/Parallel.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+template<typename Layout>
+static void benchLayoutCache(const char* name, const HeightGrid& heights, int size, const std::string& path)
+{
+	TerrainTiler tiler(size, size);
+	tiler.grid.threadCount = defaultThreadCount();
+	tiler.grid.heights = Layout::template has<AttributeRole::Height> ? &heights : nullptr;
+
+	BenchTimer keyTimer;
+	uint64_t key = meshCacheKey<Layout>(tiler);
+	double keyMs = keyTimer.elapsedMs();
+
+	Arena arena(tiledArenaBytes<Layout>(tiler));
+	BenchTimer buildTimer;
+	TiledMeshView<Layout> built = buildTiledMesh<Layout>(tiler, arena);
+	double buildMs = buildTimer.elapsedMs();
+
+	BenchTimer saveTimer;
+	bool saved = saveMeshCache(path.c_str(), key, built);
+	double saveMs = saveTimer.elapsedMs();
+	if(!saved)
+	{
+		std::cout << "Can't write " << path << std::endl;
+		return;
+	}
+
+	// Loading maps the file, the upload then reads every byte of it once,
+	// which copying into a staging buffer stands in for
+	std::vector<unsigned char> staging(built.byteSize());
+	BenchTimer loadTimer;
+	MappedFile file;
+	TiledMeshView<Layout> loaded;
+	bool mapped = loadMeshCache(path.c_str(), key, file, loaded);
+	double mapMs = loadTimer.elapsedMs();
+
+	size_t copied = 0;
+	for(size_t b = 0; b < Layout::bufferCount && mapped; b++)
+	{
+		std::memcpy(staging.data() + copied, loaded.buffers[b].data, loaded.buffers[b].bytes());
+		copied += loaded.buffers[b].bytes();
+	}
+	if(mapped)
+		std::memcpy(staging.data() + copied, loaded.indices.data, loaded.indices.bytes());
+	double loadMs = loadTimer.elapsedMs();
+
+	bool matches = mapped && loaded.vertexCount == built.vertexCount && loaded.tiles.size == built.tiles.size &&
+				   loaded.indices.size == built.indices.size &&
+				   std::memcmp(loaded.indices.data, built.indices.data, built.indices.bytes()) == 0;
+	for(size_t b = 0; b < Layout::bufferCount && matches; b++)
+		matches = std::memcmp(loaded.buffers[b].data, built.buffers[b].data, built.buffers[b].bytes()) == 0;
+
+	// A different heightmap or parameter mustn't hit the cache
+	TerrainTiler other = tiler;
+	other.vertexCacheSize = 32;
+	MappedFile stale;
+	TiledMeshView<Layout> unused;
+	bool rejects = !loadMeshCache(path.c_str(), meshCacheKey<Layout>(other), stale, unused);
+
+	std::cout << "  " << name << ": " << toMiB(std::filesystem::file_size(path)) << " MiB, key in " << keyMs
+			  << " ms, built in " << buildMs << " ms, saved in " << saveMs << " ms, mapped in " << mapMs
+			  << " ms and read in " << loadMs << " ms" << (matches ? "" : ", CACHED MESH DIFFERS")
+			  << (rejects ? "" : ", STALE CACHE ACCEPTED") << std::endl;
+
+	file.close();
+	std::remove(path.c_str());
+}
+
+void benchMeshCache(int size)
+{
+	HeightGrid heights = plateauHeightGrid(size);
+	std::string path = (std::filesystem::temp_directory_path() / "itt-bench.meshcache").string();
+	std::cout << "tiled meshes, the cache file is in the page cache when it's read back" << std::endl;
+
+	benchLayoutCache<SoALayout>("SoA", heights, size, path);
+	benchLayoutCache<QuantizedLayout>("quantized", heights, size, path);
+	benchLayoutCache<BakedHeightLayout>("baked heights", heights, size, path);
+}
@@ -0,0 +1,52 @@
+#include "Bench.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/Meshlets.hpp"
+#include "../src/Util/Parallel.hpp"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+void benchMeshlets(int size)
+{
+	// Rolling hills, so the normal cones have something to bound
+	HeightGrid heights(size, size);
+	for(int z = 0; z < size; z++)
+	for(int x = 0; x < size; x++)
+		heights.texels[static_cast<size_t>(z) * size + x] = 0.5f + 0.25f * std::sin(x * 0.05f) * std::cos(z * 0.07f);
+
+	TerrainTiler tiler(size, size);
+	tiler.grid.threadCount = defaultThreadCount();
+	tiler.vertexCacheSize = 32;
+	Arena arena(tiledArenaBytes<SoALayout>(tiler));
+	TiledMeshView<SoALayout> mesh = buildTiledMesh<SoALayout>(tiler, arena);
+
+	const float* gridPositions = reinterpret_cast<const float*>(mesh.buffers[0].data);
+	std::vector<float> positions(gridPositions, gridPositions + mesh.vertexCount * 3);
+	heights.displace(positions.data(), mesh.vertexCount, 10.0f);
+
+	const unsigned threadCounts[] = { 1, defaultThreadCount() };
+	for(unsigned threads : threadCounts)
+	{
+		MeshletBuilder builder;
+		builder.threadCount = threads;
+
+		BenchTimer timer;
+		MeshletTable table = builder.buildTiles(positions.data(), mesh.indices.data, mesh.tiles.data, mesh.tiles.size);
+		double ms = timer.elapsedMs();
+
+		bool covered = validateMeshletCoverage(table, builder, mesh.indices.data, mesh.tiles.data, mesh.tiles.size);
+
+		// The grid winds clockwise seen from above, so with counter-clockwise
+		// front faces a camera above the middle of the terrain sees its back
+		float camera[3] = { size * 0.5f, 40.0f, size * 0.5f };
+		size_t culled = 0;
+		for(const Meshlet& meshlet : table.meshlets)
+			culled += meshlet.isBackfacing(camera);
+
+		double meshlets = static_cast<double>(table.meshlets.size());
+		std::cout << threads << " threads: " << table.meshlets.size() << " meshlets in " << ms << " ms, "
+				  << table.vertices.size() / meshlets << " vertices and " << table.triangles.size() / 3 / meshlets
+				  << " triangles per meshlet, table " << toMiB(table.byteSize()) << " MiB, "
+				  << culled << " backfacing from above, coverage " << (covered ? "ok" : "FAILED") << std::endl;
+	}
+}
@@ -0,0 +1,75 @@
+#include "Bench.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/RawHeightfield.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+void benchRawMap(int size)
+{
+	// The bench's heightmap as 16-bit survey data
+	HeightGrid heights = plateauHeightGrid(size);
+	Heightfield field(size, size, HeightFormat::UNorm16);
+	for(size_t i = 0; i < heights.texels.size(); i++)
+	{
+		uint16_t value = static_cast<uint16_t>(heights.texels[i] * 65535.0f + 0.5f);
+		std::memcpy(field.samples.data() + i * sizeof(value), &value, sizeof(value));
+	}
+
+	std::string path = (std::filesystem::temp_directory_path() / "itt-bench.r16").string();
+	if(!writeRawHeightfield(path.c_str(), field.view()))
+	{
+		std::cout << "Can't write " << path << std::endl;
+		return;
+	}
+	std::cout << "wrote " << toMiB(field.samples.size()) << " MiB to " << path << ", reads below hit the page cache" << std::endl;
+
+	// What a loader that copies the whole file costs
+	BenchTimer readTimer;
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	std::vector<char> copy(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(copy.data(), static_cast<std::streamsize>(copy.size()));
+	double readMs = readTimer.elapsedMs();
+	std::cout << "read into memory: " << readMs << " ms" << std::endl;
+
+	// Opening only maps, a tile only touches its own rows' pages
+	BenchTimer openTimer;
+	MappedHeightfield mapped;
+	bool opened = mapped.open(path.c_str(), MappedAccess::Random);
+	double openMs = openTimer.elapsedMs();
+	if(!opened)
+	{
+		std::cout << "Can't map " << path << std::endl;
+		return;
+	}
+
+	const int tile = std::min(256, size);
+	int first = (size - tile) / 2;
+	BenchTimer tileTimer;
+	float sum = 0.0f;
+	for(int z = first; z < first + tile; z++)
+	for(int x = first; x < first + tile; x++)
+		sum += mapped.view.sample(x, z);
+	double tileMs = tileTimer.elapsedMs();
+
+	mapped.file.advise(MappedAccess::Sequential);
+	BenchTimer gridTimer;
+	HeightGrid grid = mapped.view.toHeightGrid();
+	double gridMs = gridTimer.elapsedMs();
+
+	bool matches = mapped.view.width == size && mapped.view.height == size &&
+				   grid.texels == field.view().toHeightGrid().texels;
+
+	std::cout << "mapped in " << openMs << " ms, a " << tile << "x" << tile << " tile read in " << tileMs << " ms (sum "
+			  << sum << "), the whole map converted to floats in " << gridMs << " ms"
+			  << (matches ? "" : ", SAMPLES DON'T MATCH") << std::endl;
+
+	mapped.file.close();
+	std::remove(path.c_str());
+}
@@ -0,0 +1,75 @@
+#include "Bench.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/Roam.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+void benchRoam(int size)
+{
+	if(!Roam::supports(size, size))
+	{
+		std::cout << "ROAM needs a power-of-two size, got " << size << std::endl;
+		return;
+	}
+
+	HeightGrid heights = plateauHeightGrid(size);
+
+	BenchTimer buildTimer;
+	Roam roam(heights);
+	double buildMs = buildTimer.elapsedMs();
+	std::cout << "split errors computed in " << buildMs << " ms" << std::endl;
+
+	// A low flight over the map and back, like the viewer's camera
+	float scale = size * 0.1f;
+	float s = static_cast<float>(size);
+	const size_t budgets[] = { 8192, 32768, 131072 };
+	std::vector<unsigned int> indices;
+	for(size_t budget : budgets)
+	{
+		roam.triangleBudget = budget;
+
+		// The first frame builds the mesh from scratch, the rest only follow the camera
+		const int frames = 400;
+		size_t firstSplits = 0;
+		size_t totalSplits = 0, totalMerges = 0, maxChanges = 0, totalTriangles = 0;
+		double queueMs = 0.0, refineMs = 0.0, maxFrameMs = 0.0;
+		float totalError = 0.0f;
+		for(int frame = 0; frame < frames; frame++)
+		{
+			float t = static_cast<float>(frame) / frames;
+			LodCamera camera;
+			camera.position[0] = s * (0.1f + 0.8f * t);
+			camera.position[1] = scale * (1.0f + 0.5f * std::sin(t * 6.2831853f));
+			camera.position[2] = s * (0.5f + 0.3f * std::sin(t * 12.566371f));
+			camera.heightScale = scale;
+
+			RoamStats stats = roam.update(camera);
+			if(frame == 0)
+			{
+				firstSplits = stats.splits;
+				continue;
+			}
+			totalSplits += stats.splits;
+			totalMerges += stats.merges;
+			maxChanges = std::max(maxChanges, stats.splits + stats.merges);
+			totalTriangles += stats.triangles;
+			totalError += stats.maxSplitError;
+			queueMs += stats.queueMs;
+			refineMs += stats.refineMs;
+			maxFrameMs = std::max(maxFrameMs, stats.queueMs + stats.refineMs);
+		}
+
+		roam.writeIndices(indices);
+		bool valid = validateRoamIndices(indices, size);
+
+		int following = frames - 1;
+		std::cout << "budget " << budget << ": " << firstSplits << " splits on the first frame, then " << totalTriangles / following
+				  << " triangles, " << static_cast<double>(totalSplits) / following << " splits and "
+				  << static_cast<double>(totalMerges) / following << " merges per frame (" << maxChanges
+				  << " at most), worst unsplit error " << totalError / following << " px, queues " << queueMs / following
+				  << " ms, refinement " << refineMs / following << " ms, slowest frame " << maxFrameMs << " ms"
+				  << (valid ? "" : ", MESH HAS CRACKS") << std::endl;
+	}
+}
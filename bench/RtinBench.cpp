@@ -0,0 +1,46 @@
+#include "Bench.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/Rtin.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Like the smooth regions of the noise heightmaps
+HeightGrid plateauHeightGrid(int size)
+{
+	HeightGrid heights(size, size);
+	for(int z = 0; z < size; z++)
+	for(int x = 0; x < size; x++)
+	{
+		float hills = 0.5f + 0.4f * std::sin(x * 6.0f / size) * std::cos(z * 5.0f / size) + 0.05f * std::sin(x * 0.3f + z * 0.2f);
+		heights.texels[static_cast<size_t>(z) * size + x] = std::clamp(hills, 0.3f, 0.7f);
+	}
+	return heights;
+}
+
+void benchRtin(int size)
+{
+	// RTIN needs a power of two
+	int rtinSize = 1;
+	while(rtinSize * 2 <= size)
+		rtinSize *= 2;
+
+	HeightGrid heights = plateauHeightGrid(rtinSize);
+
+	BenchTimer timer;
+	Rtin rtin(heights);
+	std::cout << rtinSize << "x" << rtinSize << " errors computed in " << timer.elapsedMs() << " ms" << std::endl;
+
+	double gridTriangles = 2.0 * rtinSize * rtinSize;
+	const float maxErrors[] = { 0.0f, 0.0005f, 0.001f, 0.002f, 0.005f, 0.01f, 0.02f, 0.05f };
+	for(float maxError : maxErrors)
+	{
+		BenchTimer extractTimer;
+		GridTriangulation triangulation = rtin.extract(maxError);
+		double ms = extractTimer.elapsedMs();
+
+		std::cout << "  max error " << maxError << ": " << triangulation.triangleCount() << " triangles ("
+				  << 100.0 * triangulation.triangleCount() / gridTriangles << "% of the grid), "
+				  << triangulation.vertexCount() << " vertices, extracted in " << ms << " ms" << std::endl;
+	}
+}
@@ -0,0 +1,101 @@
+#include "Bench.hpp"
+#include "../src/Terrain/ChunkedLod.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/LodSeams.hpp"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+template<typename Layout>
+static void reportSeamMesh(const char* name, const TerrainTiler& tiler, const ChunkedLod& lod)
+{
+	Arena arena(chunkedArenaBytes<Layout>(tiler, lod));
+
+	BenchTimer timer;
+	TiledMeshView<Layout> mesh = buildChunkedMesh<Layout>(tiler, lod, arena);
+	double ms = timer.elapsedMs();
+
+	std::cout << "  " << name << ": " << mesh.vertexCount << " vertices, " << mesh.indices.size << " shared indices, "
+			  << toMiB(mesh.byteSize()) << " MiB, built in " << ms << " ms" << std::endl;
+}
+
+void benchSeams(int size)
+{
+	HeightGrid heights = plateauHeightGrid(size);
+
+	ChunkedLod lod;
+	lod.threadCount = defaultThreadCount();
+	lod.build(heights);
+
+	// Every stitching variant of every chunk shape on its own
+	std::vector<std::pair<int, int>> shapes;
+	bool variantsValid = true;
+	for(const LodChunk& chunk : lod.chunks)
+	{
+		std::pair<int, int> shape(chunk.rows, chunk.columns);
+		if(std::find(shapes.begin(), shapes.end(), shape) != shapes.end())
+			continue;
+		shapes.push_back(shape);
+		variantsValid = variantsValid && validateStitchVariants(chunk.rows, chunk.columns);
+	}
+	std::cout << shapes.size() << " chunk shapes x " << seamVariantCount << " stitching variants: "
+			  << (variantsValid ? "all watertight" : "SOME VARIANTS LEAK") << std::endl;
+
+	TerrainTiler tiler(size, size);
+	tiler.grid.threadCount = defaultThreadCount();
+	tiler.vertexCacheSize = 32;
+	const SeamMode modes[] = { SeamMode::None, SeamMode::Skirts, SeamMode::Stitching };
+	const char* modeNames[] = { "no seams", "skirts", "stitching" };
+	for(int m = 0; m < 3; m++)
+	{
+		lod.seams = modes[m];
+		reportSeamMesh<SoALayout>(modeNames[m], tiler, lod);
+	}
+
+	// Heights scaled like a steep version of the viewer's terrain
+	float scale = size * 0.1f;
+	float s = static_cast<float>(size);
+	const float cameras[][3] =
+	{
+		{ s * 0.5f, s / 6.0f, s * 1.7f },
+		{ s * 0.5f, scale * 0.8f, s * 0.5f },
+		{ 0.0f, scale * 0.8f, 0.0f },
+		{ s * 0.5f, s * 2.0f, s * 0.5f },
+	};
+
+	std::vector<uint32_t> selected;
+	std::vector<uint8_t> masks, noMasks;
+	for(const float* position : cameras)
+	{
+		LodCamera camera;
+		camera.position[0] = position[0];
+		camera.position[1] = position[1];
+		camera.position[2] = position[2];
+		camera.heightScale = scale;
+
+		lod.select(camera, 1.0f, selected);
+		size_t selectedCount = selected.size();
+		noMasks.assign(selected.size(), 0);
+		bool unstitched = validateChunkSeams(lod, selected, noMasks);
+
+		const int repeats = 100;
+		BenchTimer restrictTimer;
+		std::vector<uint32_t> restricted;
+		for(int r = 0; r < repeats; r++)
+		{
+			restricted = selected;
+			lod.restrictSelection(restricted, masks);
+		}
+		double restrictUs = restrictTimer.elapsedMs() * 1000.0 / repeats;
+
+		size_t stitchedSides = 0;
+		for(uint8_t mask : masks)
+			for(int bit = 0; bit < 4; bit++)
+				stitchedSides += (mask >> bit) & 1;
+
+		std::cout << "  camera (" << position[0] << ", " << position[1] << ", " << position[2] << "): " << selectedCount
+				  << " chunks " << (unstitched ? "without cracks" : "with cracks") << ", restricted to " << restricted.size()
+				  << " with " << stitchedSides << " stitched sides in " << restrictUs << " us, "
+				  << (validateChunkSeams(lod, restricted, masks) ? "watertight" : "STITCHED MESH LEAKS") << std::endl;
+	}
+}
@@ -0,0 +1,33 @@
+#include "Bench.hpp"
+#include "../src/Terrain/TerrainMesh.hpp"
+#include "../src/Terrain/Arena.hpp"
+#include "../src/Terrain/VertexCache.hpp"
+#include <iostream>
+
+static void benchPrimitive(const char* name, TerrainMeshBuilder builder, PrimitiveMode mode)
+{
+	builder.primitive = mode;
+	Arena arena(builder.arenaBytes());
+
+	BenchTimer timer;
+	TerrainMeshView mesh = builder.build(arena);
+	double ms = timer.elapsedMs();
+
+	std::cout << name << ": " << mesh.indices.size << " indices, " << toMiB(mesh.indices.bytes())
+			  << " MiB, " << ms << " ms" << std::endl;
+
+	const int cacheSizes[] = { 16, 32 };
+	for(int cacheSize : cacheSizes)
+	{
+		VertexCacheStats stats = simulateFifoCache(mesh.indices.data, mesh.indices.size, mode, cacheSize);
+		std::cout << "  FIFO " << cacheSize << ": ACMR " << stats.acmr() << ", ATVR " << stats.atvr()
+				  << " (" << stats.triangles << " triangles)" << std::endl;
+	}
+}
+
+void benchStrips(int size)
+{
+	TerrainMeshBuilder builder(size, size);
+	benchPrimitive("triangle list ", builder, PrimitiveMode::Triangles);
+	benchPrimitive("triangle strip", builder, PrimitiveMode::TriangleStrip);
+}
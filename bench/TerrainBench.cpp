@@ -0,0 +1,63 @@
+#include "Bench.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+struct BenchEntry
+{
+	const char* name;
+	void (*run)(int size);
+};
+
+static const BenchEntry benches[] =
+{
+	{ "mesh", benchMeshBuild },
+	{ "alloc", benchAllocations },
+	{ "threads", benchThreadScaling },
+	{ "kernels", benchKernels },
+	{ "layouts", benchLayouts },
+	{ "tiles", benchTiles },
+	{ "strips", benchStrips },
+	{ "vcache", benchVertexCache },
+	{ "meshlets", benchMeshlets },
+	{ "rtin", benchRtin },
+	{ "tin", benchGreedyTin },
+	{ "decimate", benchDecimation },
+	{ "chunklod", benchChunkedLod },
+	{ "cdlod", benchCdlod },
+	{ "clipmap", benchClipmap },
+	{ "roam", benchRoam },
+	{ "seams", benchSeams },
+	{ "schedule", benchLodScheduler },
+	{ "rawmap", benchRawMap },
+	{ "tiled", benchTiledHeightfield },
+	{ "meshcache", benchMeshCache },
+};
+
+int main(int argc, char** argv)
+{
+	const char* name = argc > 1 ? argv[1] : nullptr;
+	int size = argc > 2 ? std::atoi(argv[2]) : 2048;
+
+	bool ran = false;
+	for(const BenchEntry& bench : benches)
+	{
+		if(name != nullptr && std::strcmp(name, bench.name) != 0)
+			continue;
+
+		std::cout << "== " << bench.name << " (" << size << "x" << size << ")" << std::endl;
+		bench.run(size);
+		ran = true;
+	}
+
+	if(!ran)
+	{
+		std::cout << "Usage: terrain-bench [name] [size]\nBenchmarks:";
+		for(const BenchEntry& bench : benches)
+			std::cout << " " << bench.name;
+		std::cout << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,44 @@
+#include "Bench.hpp"
+#include "../src/Terrain/TerrainMesh.hpp"
+#include "../src/Terrain/Arena.hpp"
+#include "../src/Util/Parallel.hpp"
+#include <cstring>
+#include <iostream>
+
+static bool sameBytes(const TerrainMeshView& a, const TerrainMeshView& b)
+{
+	return std::memcmp(a.positions.data, b.positions.data, a.positions.bytes()) == 0 &&
+		   std::memcmp(a.texCoords.data, b.texCoords.data, a.texCoords.bytes()) == 0 &&
+		   std::memcmp(a.indices.data, b.indices.data, a.indices.bytes()) == 0;
+}
+
+void benchThreadScaling(int size)
+{
+	TerrainMeshBuilder builder(size, size);
+
+	Arena serialArena(builder.arenaBytes());
+	TerrainMeshView serial = builder.build(serialArena);
+
+	Arena arena(builder.arenaBytes());
+	double serialMs = 0.0;
+	unsigned cores = defaultThreadCount();
+	// Powers of two, then all the cores when their count isn't one
+	for(unsigned threads = 1; threads <= cores; threads = threads < cores && threads * 2 > cores ? cores : threads * 2)
+	{
+		builder.threadCount = threads;
+
+		// Warm pass so page faults on the arena don't count against one thread count
+		arena.reset();
+		builder.build(arena);
+
+		arena.reset();
+		BenchTimer timer;
+		TerrainMeshView mesh = builder.build(arena);
+		double ms = timer.elapsedMs();
+		if(threads == 1)
+			serialMs = ms;
+
+		std::cout << threads << " thread(s): " << ms << " ms, speedup " << serialMs / ms
+				  << (sameBytes(serial, mesh) ? ", identical" : ", MISMATCH") << std::endl;
+	}
+}
@@ -0,0 +1,69 @@
+#include "Bench.hpp"
+#include "../src/Terrain/TerrainTiler.hpp"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// Every triangle as the grid corners it spans, sorted, so meshes with
+// different vertex numbering can be compared
+static std::vector<uint64_t> cornerTriangles(const float* positions, const uint16_t* indices16,
+											 const unsigned int* indices32, size_t count, size_t baseVertex,
+											 int height)
+{
+	std::vector<uint64_t> result;
+	result.reserve(count / 3);
+	for(size_t k = 0; k < count; k += 3)
+	{
+		uint64_t key = 0;
+		for(size_t c = 0; c < 3; c++)
+		{
+			size_t v = baseVertex + (indices16 != nullptr ? indices16[k + c] : indices32[k + c]);
+			uint64_t corner = static_cast<uint64_t>(positions[v * 3]) * static_cast<uint64_t>(height + 1) +
+							  static_cast<uint64_t>(positions[v * 3 + 2]);
+			key = key * 0x100000ull + corner;
+		}
+		result.push_back(key);
+	}
+	return result;
+}
+
+void benchTiles(int size)
+{
+	TerrainMeshBuilder builder(size, size);
+	Arena flatArena(builder.arenaBytes());
+
+	BenchTimer flatTimer;
+	TerrainMeshView flat = builder.build(flatArena);
+	double flatMs = flatTimer.elapsedMs();
+
+	TerrainTiler tiler(size, size);
+	Arena tiledArena(tiledArenaBytes<SoALayout>(tiler));
+
+	BenchTimer tiledTimer;
+	TiledMeshView<SoALayout> tiled = buildTiledMesh<SoALayout>(tiler, tiledArena);
+	double tiledMs = tiledTimer.elapsedMs();
+
+	std::cout << "32-bit grid: " << flat.vertexCount() << " vertices, " << toMiB(flat.indices.bytes())
+			  << " MiB indices, " << flatMs << " ms" << std::endl;
+	std::cout << "16-bit tiles: " << tiled.tiles.size << " tiles, " << tiled.vertexCount << " vertices, "
+			  << toMiB(tiled.indices.bytes()) << " MiB indices, " << tiledMs << " ms" << std::endl;
+
+	// Same surface: identical triangles once mapped back to grid corners
+	if(size <= 2048)
+	{
+		const float* tiledPositions = reinterpret_cast<const float*>(tiled.buffers[0].data);
+		std::vector<uint64_t> tiledTriangles;
+		for(const TerrainTile& tile : tiled.tiles)
+		{
+			std::vector<uint64_t> triangles = cornerTriangles(tiledPositions, tiled.indices.data + tile.firstIndex, nullptr,
+															  tile.indexCount, tile.baseVertex, size);
+			tiledTriangles.insert(tiledTriangles.end(), triangles.begin(), triangles.end());
+		}
+
+		std::vector<uint64_t> flatTriangles = cornerTriangles(flat.positions.data, nullptr, flat.indices.data,
+															  flat.indices.size, 0, size);
+		std::sort(tiledTriangles.begin(), tiledTriangles.end());
+		std::sort(flatTriangles.begin(), flatTriangles.end());
+		std::cout << "same triangles: " << (tiledTriangles == flatTriangles ? "yes" : "NO") << std::endl;
+	}
+}
@@ -0,0 +1,125 @@
+#include "Bench.hpp"
+#include "../src/Terrain/GeometryClipmap.hpp"
+#include "../src/Terrain/HeightGrid.hpp"
+#include "../src/Terrain/TiledHeightfield.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+void benchTiledHeightfield(int size)
+{
+	// The bench's heightmap as 16-bit survey data
+	HeightGrid heights = plateauHeightGrid(size);
+	Heightfield field(size, size, HeightFormat::UNorm16);
+	for(size_t i = 0; i < heights.texels.size(); i++)
+	{
+		uint16_t value = static_cast<uint16_t>(heights.texels[i] * 65535.0f + 0.5f);
+		std::memcpy(field.samples.data() + i * sizeof(value), &value, sizeof(value));
+	}
+	HeightGrid expected = field.view().toHeightGrid();
+
+	const int tileSize = 256;
+	std::string path = (std::filesystem::temp_directory_path() / "itt-bench.ittt").string();
+	const bool compressions[] = { false, true };
+	for(bool compress : compressions)
+	{
+		BenchTimer writeTimer;
+		if(!writeTiledHeightfield(path.c_str(), field.view(), tileSize, compress))
+		{
+			std::cout << "Can't write " << path << std::endl;
+			return;
+		}
+		double writeMs = writeTimer.elapsedMs();
+		std::cout << (compress ? "delta compressed" : "uncompressed") << " " << tileSize << "x" << tileSize << " tiles: "
+				  << toMiB(std::filesystem::file_size(path)) << " MiB for " << toMiB(field.samples.size())
+				  << " MiB of samples, written in " << writeMs << " ms" << std::endl;
+
+		// Windows of a flight across the map, like a mesher following the
+		// camera, then scattered point queries, for a few cache sizes
+		const size_t cacheSizes[] = { 4, 16, 64 };
+		for(size_t cacheTiles : cacheSizes)
+		{
+			TiledHeightfieldReader reader;
+			if(!reader.open(path.c_str(), cacheTiles))
+			{
+				std::cout << "Can't open " << path << std::endl;
+				return;
+			}
+
+			const int window = std::min(512, size);
+			const int steps = 200;
+			bool matches = true;
+			BenchTimer windowTimer;
+			for(int step = 0; step < steps; step++)
+			{
+				float t = static_cast<float>(step) / steps;
+				int x = static_cast<int>((size - window) * t);
+				int z = static_cast<int>((size - window) * (0.5f + 0.5f * std::sin(t * 6.2831853f)));
+				HeightGrid grid = reader.readGrid(x, z, window, window);
+				if(step % 50 == 0)
+				{
+					for(int r = 0; r < window && matches; r++)
+					for(int c = 0; c < window && matches; c++)
+						matches = grid.texels[static_cast<size_t>(r) * window + c] == expected.texel(x + c, z + r);
+				}
+			}
+			double windowMs = windowTimer.elapsedMs() / steps;
+			TileCacheStats windows = reader.stats;
+
+			std::mt19937 random(7);
+			std::uniform_int_distribution<int> coordinate(0, size - 1);
+			const int queries = 10000;
+			float sum = 0.0f;
+			BenchTimer queryTimer;
+			for(int q = 0; q < queries; q++)
+				sum += reader.sample(coordinate(random), coordinate(random));
+			double queryUs = queryTimer.elapsedMs() * 1000.0 / queries;
+
+			TileCacheStats total = reader.stats;
+			std::cout << "  cache of " << cacheTiles << " tiles (" << toMiB(cacheTiles * tileSize * tileSize * sizeof(uint16_t))
+					  << " MiB): " << window << "x" << window << " windows in " << windowMs << " ms, "
+					  << windows.hits << " hits, " << windows.misses << " misses, " << windows.evictions << " evictions; "
+					  << "points in " << queryUs << " us, " << total.hits - windows.hits << " hits, "
+					  << total.misses - windows.misses << " misses (sum " << sum << "), " << toMiB(total.bytesRead)
+					  << " MiB read" << (matches ? "" : ", SAMPLES DON'T MATCH") << std::endl;
+		}
+	}
+
+	// A clipmap fed from the compressed file along a straight flight,
+	// against the same flight over the whole map in memory
+	TiledHeightfieldReader reader;
+	if(!reader.open(path.c_str(), 16))
+	{
+		std::cout << "Can't open " << path << std::endl;
+		return;
+	}
+	GeometryClipmap inMemory, tiled;
+	inMemory.build(expected);
+	tiled.build(reader);
+	const int frames = 300;
+	double memoryMs = 0.0, tiledMs = 0.0;
+	bool clipmapMatches = true;
+	for(int frame = 0; frame < frames; frame++)
+	{
+		float row = size * 0.1f + frame * 1.7f, column = size * 0.2f + frame * 0.9f;
+		BenchTimer memoryTimer;
+		inMemory.update(row, column);
+		memoryMs += memoryTimer.elapsedMs();
+		BenchTimer tiledTimer;
+		tiled.update(row, column);
+		tiledMs += tiledTimer.elapsedMs();
+		if(frame % 100 == 0 || frame == frames - 1)
+			clipmapMatches = clipmapMatches && validateClipmap(tiled, expected);
+	}
+	std::cout << "clipmap from 16 cached tiles: " << tiled.levels.size() << " levels, " << tiledMs / frames
+			  << " ms/frame against " << memoryMs / frames << " from memory, " << reader.stats.misses << " misses, "
+			  << toMiB(reader.stats.bytesRead) << " MiB read" << (clipmapMatches ? "" : ", CLIPMAP SAMPLES DON'T MATCH")
+			  << std::endl;
+
+	std::remove(path.c_str());
+}
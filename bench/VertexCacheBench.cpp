@@ -0,0 +1,45 @@
+#include "Bench.hpp"
+#include "../src/Terrain/TerrainTiler.hpp"
+#include "../src/Terrain/VertexCache.hpp"
+#include <iostream>
+
+static void report(const char* label, const TiledMeshView<SoALayout>& mesh, int cacheSize)
+{
+	// Tiles are drawn one after another, so their stats simply add up
+	VertexCacheStats fifo, lru;
+	for(const TerrainTile& tile : mesh.tiles)
+	{
+		VertexCacheStats f = simulateFifoCache(mesh.indices.data + tile.firstIndex, tile.indexCount, mesh.primitive, cacheSize);
+		VertexCacheStats l = simulateLruCache(mesh.indices.data + tile.firstIndex, tile.indexCount, mesh.primitive, cacheSize);
+		fifo.triangles += f.triangles;
+		fifo.vertices += f.vertices;
+		fifo.transforms += f.transforms;
+		lru.triangles += l.triangles;
+		lru.vertices += l.vertices;
+		lru.transforms += l.transforms;
+	}
+
+	std::cout << "  " << label << ": FIFO ACMR " << fifo.acmr() << " ATVR " << fifo.atvr()
+			  << ", LRU ACMR " << lru.acmr() << " ATVR " << lru.atvr() << std::endl;
+}
+
+void benchVertexCache(int size)
+{
+	const int cacheSizes[] = { 16, 32 };
+	for(int cacheSize : cacheSizes)
+	{
+		TerrainTiler tiler(size, size);
+		Arena rowArena(tiledArenaBytes<SoALayout>(tiler));
+		TiledMeshView<SoALayout> rowOrder = buildTiledMesh<SoALayout>(tiler, rowArena);
+
+		tiler.vertexCacheSize = cacheSize;
+		Arena optimizedArena(tiledArenaBytes<SoALayout>(tiler));
+		BenchTimer timer;
+		TiledMeshView<SoALayout> optimized = buildTiledMesh<SoALayout>(tiler, optimizedArena);
+		double ms = timer.elapsedMs();
+
+		std::cout << "cache size " << cacheSize << " (optimized build " << ms << " ms)" << std::endl;
+		report("row order", rowOrder, cacheSize);
+		report("optimized", optimized, cacheSize);
+	}
+}
@@ -1,6 +1,25 @@
 #version 460 core
+#ifdef GRID_POSITIONS
+layout(location = 0) in vec2 aGrid;
+#else
 layout(location = 0) in vec3 aPos;
+#endif
+#ifndef DERIVE_TEXCOORDS
 layout(location = 1) in vec2 aTexPos;
+#endif
+#ifdef BAKED_HEIGHTS
+layout(location = 2) in float aHeight;
+#endif
+#ifdef CDLOD
+// Per instance: grid i and j of the patch's first corner, grid cells per
+// patch cell and level, then the camera distances of the level's morph
+layout(location = 3) in vec4 aNode;
+layout(location = 4) in vec2 aMorph;
+#endif
+#ifdef GEOMORPH
+// Height of the parent chunk's surface at this vertex, lowered like the vertex
+layout(location = 5) in float aMorphHeight;
+#endif
 
 out float y;
 out vec2 texPos;
@@ -11,11 +30,82 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform float scale;
 uniform sampler2D tex;
+uniform vec2 gridSize;
+#ifdef GEOMORPH
+uniform float morph;	// Per chunk, 0 at its own level and 1 at its parent's
+#endif
+#ifdef CDLOD
+uniform vec3 cameraPosition;	// In terrain space
+#endif
+#ifdef CLIPMAP
+// Toroidal height buffer of each level, where sample (r, c) is texel
+// (c mod clipSamples, r mod clipSamples) of layer clipLevel
+uniform sampler2DArray clipmap;
+uniform int clipLevel;
+uniform int clipSamples;
+uniform ivec2 clipOrigin;	// Sample r and c of the level's first sample
+
+float clipHeight(ivec2 patchPos)
+{
+	ivec2 wrapped = (clipOrigin + patchPos) % clipSamples;
+	wrapped += ivec2(lessThan(wrapped, ivec2(0))) * clipSamples;
+	return texelFetch(clipmap, ivec3(wrapped.y, wrapped.x, clipLevel), 0).r;
+}
+#endif
 
 void main() 
 {
+#ifdef GRID_POSITIONS
+	vec3 aPos = vec3(aGrid.x, 0.0, aGrid.y);
+#endif
+#ifdef CDLOD
+	// Odd patch corners slide onto the next level's grid as the camera
+	// gets further away, patches past the grid's edge are squashed onto it
+	vec2 patchPos = aPos.xz;
+	vec2 gridPos = min(aNode.xy + patchPos * aNode.z, gridSize);
+	float cameraDistance = distance(cameraPosition, vec3(gridPos.x, texture(tex, gridPos / gridSize).r * scale, gridPos.y));
+	float morph = clamp((cameraDistance - aMorph.x) / (aMorph.y - aMorph.x), 0.0, 1.0);
+	gridPos = min(aNode.xy + (patchPos - fract(patchPos * 0.5) * 2.0 * morph) * aNode.z, gridSize);
+	aPos = vec3(gridPos.x, 0.0, gridPos.y);
+#endif
+#ifdef CLIPMAP
+	// Towards its outer edge a level blends into the next level's surface,
+	// whose samples are every other one of this level's
+	ivec2 patchPos = ivec2(aPos.xz);
+	ivec2 odd = patchPos & 1;
+	float fine = clipHeight(patchPos);
+	float coarse = 0.5 * (clipHeight(patchPos - odd) + clipHeight(patchPos + odd));
+
+	float cells = float(clipSamples - 1);
+	float transition = cells * 0.1;
+	vec2 edgeDistance = min(aPos.xz, cells - aPos.xz);
+	float blend = clamp((transition - min(edgeDistance.x, edgeDistance.y)) / transition, 0.0, 1.0);
+	float clipmapHeight = mix(fine, coarse, blend);
+
+	vec2 gridPos = clamp(vec2(clipOrigin + patchPos) * float(1 << clipLevel), vec2(0.0), gridSize);
+	aPos = vec3(gridPos.x, 0.0, gridPos.y);
+#endif
+#ifdef DERIVE_TEXCOORDS
+	vec2 aTexPos = aPos.xz / gridSize;
+#endif
+
+#ifdef CLIPMAP
+	sampled = vec4(clipmapHeight);
+#elif defined(BAKED_HEIGHTS)
+	sampled = vec4(aHeight);
+#else
 	sampled = texture(tex, aTexPos);
+#endif
 	y = sampled.r;
 
-	gl_Position = projection * view * model * vec4(aPos.x, y * scale, aPos.z, 1.0);
+	// Skirt vertices are lowered by a negative y, baked heights already include it
+#ifdef BAKED_HEIGHTS
+	float height = y;
+#else
+	float height = y + aPos.y;
+#endif
+#ifdef GEOMORPH
+	height = mix(height, aMorphHeight, morph);
+#endif
+	gl_Position = projection * view * model * vec4(aPos.x, height * scale, aPos.z, 1.0);
 }
@@ -3,30 +3,154 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <cstring>
+#include <mutex>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 int numTexturesLoaded = 0;
 
+// stb_image's flip setting is global, so it's set once and every decoding
+// thread goes through here before reading it
+static void flipImagesOnLoad()
+{
+	static std::once_flag flipOnce;
+	std::call_once(flipOnce, [] { stbi_set_flip_vertically_on_load(true); });
+}
+
+static std::string addDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+	if(defines.empty())
+		return source;
+
+	std::string header;
+	for(const std::string& define : defines)
+		header += "#define " + define + "\n";
+
+	// Defines have to come after #version
+	size_t insertAt = 0;
+	if(source.compare(0, 8, "#version") == 0)
+	{
+		insertAt = source.find('\n');
+		insertAt = insertAt == std::string::npos ? source.size() : insertAt + 1;
+	}
+
+	return source.substr(0, insertAt) + header + source.substr(insertAt);
+}
+
 namespace RM {
-	Texture loadTexture(const char* path)
+	Texture loadTexture(const char* path, HeightGrid* heights)
 	{
 		int width, height, channels;
-		stbi_set_flip_vertically_on_load(true);
+		flipImagesOnLoad();
 		unsigned char* data = stbi_load(path, &width, &height, &channels, 4);
 		if(data == nullptr)
 		{
 			std::cout << "Failed to load image!" << std::endl;
 		}
 
+        if(heights != nullptr && data != nullptr)
+        {
+            *heights = HeightGrid(width, height);
+            for(size_t i = 0; i < heights->texels.size(); i++)
+                heights->texels[i] = data[i * 4] / 255.0f;
+        }
+
         Texture t(data, numTexturesLoaded++, width, height);
 
 		stbi_image_free(data);
         return t;
 	}
 
-	Shader loadShaders(const char * vertexPath, const char * fragmentPath)
+	Heightfield loadHeightfield(const char* path)
+	{
+		flipImagesOnLoad();
+
+		int width, height, channels;
+		void* data = nullptr;
+		HeightFormat format = HeightFormat::UNorm8;
+		if(stbi_is_hdr(path))
+		{
+			data = stbi_loadf(path, &width, &height, &channels, 1);
+			format = HeightFormat::Float32;
+		}
+		else if(stbi_is_16_bit(path))
+		{
+			data = stbi_load_16(path, &width, &height, &channels, 1);
+			format = HeightFormat::UNorm16;
+		}
+		else
+		{
+			data = stbi_load(path, &width, &height, &channels, 1);
+		}
+
+		if(data == nullptr)
+		{
+			std::cout << "Failed to load heightmap " << path << "!" << std::endl;
+			return Heightfield();
+		}
+
+		Heightfield field(width, height, format);
+		std::memcpy(field.samples.data(), data, field.samples.size());
+		stbi_image_free(data);
+		return field;
+	}
+
+	MappedHeightfield mapHeightfield(const char* path, MappedAccess access)
+	{
+		MappedHeightfield mapped;
+		if(!mapped.open(path, access))
+			std::cout << "Failed to map heightmap " << path << "!" << std::endl;
+		return mapped;
+	}
+
+	TiledHeightfieldReader openTiledHeightfield(const char* path, size_t cacheTiles)
+	{
+		TiledHeightfieldReader reader;
+		if(!reader.open(path, cacheTiles))
+			std::cout << "Failed to open tiled heightmap " << path << "!" << std::endl;
+		return reader;
+	}
+
+	HeightmapData prepareHeightmap(const char* path, bool withHeights)
+	{
+		HeightmapData data;
+		if(isRawHeightfieldPath(path))
+		{
+			data.mapped = mapHeightfield(path);
+			data.view = data.mapped.view;
+		}
+		else
+		{
+			data.field = loadHeightfield(path);
+			data.view = data.field.view();
+		}
+
+		if(withHeights && !data.view.empty())
+			data.heights = data.view.toHeightGrid();
+		return data;
+	}
+
+	std::future<HeightmapData> prepareHeightmapAsync(const std::string& path, bool withHeights)
+	{
+		return std::async(std::launch::async, [path, withHeights] { return prepareHeightmap(path.c_str(), withHeights); });
+	}
+
+	Texture uploadHeightmap(const HeightmapData& data)
+	{
+		return Texture(data.view, numTexturesLoaded++);
+	}
+
+	Texture loadHeightmap(const char* path, HeightGrid* heights)
+	{
+		HeightmapData data = prepareHeightmap(path, heights != nullptr);
+		if(heights != nullptr)
+			*heights = std::move(data.heights);
+		return uploadHeightmap(data);
+	}
+
+	ShaderSources readShaders(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines)
 	{
 		std::ifstream vertex(vertexPath);
         std::ifstream fragment(fragmentPath);
@@ -37,9 +161,25 @@ namespace RM {
         std::stringstream fStream;
         fStream << fragment.rdbuf();
 
-        vertex.close();
-        fragment.close();
+        return { addDefines(vStream.str(), defines), addDefines(fStream.str(), defines) };
+	}
+
+	std::future<ShaderSources> readShadersAsync(const std::string& vertexPath, const std::string& fragmentPath,
+												const std::vector<std::string>& defines)
+	{
+		return std::async(std::launch::async, [vertexPath, fragmentPath, defines]
+		{
+			return readShaders(vertexPath.c_str(), fragmentPath.c_str(), defines);
+		});
+	}
 
-        return Shader(vStream.str(), fStream.str());
+	Shader createShader(const ShaderSources& sources)
+	{
+		return Shader(sources.vertex, sources.fragment);
+	}
+
+	Shader loadShaders(const char * vertexPath, const char * fragmentPath, const std::vector<std::string>& defines)
+	{
+		return createShader(readShaders(vertexPath, fragmentPath, defines));
 	}
 }
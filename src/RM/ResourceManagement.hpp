@@ -1,12 +1,72 @@
 #pragma once
 #include "../Shader/Shader.hpp"
 #include "../Texture/Texture.hpp"
+#include "../Terrain/HeightGrid.hpp"
+#include "../Terrain/Heightfield.hpp"
+#include "../Terrain/RawHeightfield.hpp"
+#include "../Terrain/TiledHeightfield.hpp"
+#include <future>
+#include <string>
+#include <vector>
 
 namespace RM
 {
-	// Load a texture's data
-	Texture loadTexture(const char* path);
+	// Load a texture's data, optionally keeping a CPU copy of its red channel
+	Texture loadTexture(const char* path, HeightGrid* heights = nullptr);
 
-	// Loads a vertex and fragment shader from paths
-	Shader loadShaders(const char* vertexPath, const char* fragmentPath);
+	// Load a heightmap's first channel in its own bit depth: 16-bit PNGs as
+	// UNorm16, HDR images as Float32 and everything else as UNorm8. Colour
+	// images are reduced to their luminance. Empty if it can't be loaded.
+	Heightfield loadHeightfield(const char* path);
+
+	// Maps a raw heightmap (.raw, .r16 or .f32, see Terrain/RawHeightfield.hpp)
+	// without copying or decoding it. Empty if it can't be mapped.
+	MappedHeightfield mapHeightfield(const char* path, MappedAccess access = MappedAccess::Sequential);
+
+	// Opens a tiled heightfield (see Terrain/TiledHeightfield.hpp) for reading
+	// through a cache of cacheTiles decoded tiles. Empty if it can't be opened.
+	TiledHeightfieldReader openTiledHeightfield(const char* path, size_t cacheTiles);
+
+	// A heightmap ready to upload: decoded into field or mapped, view
+	// pointing at whichever holds it, and its float copy if asked for
+	struct HeightmapData
+	{
+		Heightfield field;
+		MappedHeightfield mapped;
+		HeightfieldView view;
+		HeightGrid heights;
+	};
+
+	// The file and CPU side of loadHeightmap(), safe to run on any thread
+	HeightmapData prepareHeightmap(const char* path, bool withHeights);
+	std::future<HeightmapData> prepareHeightmapAsync(const std::string& path, bool withHeights);
+
+	// Creates the texture of a prepared heightmap, on the GL context's thread
+	Texture uploadHeightmap(const HeightmapData& data);
+
+	// Load a heightmap as a single-channel texture of its own precision,
+	// optionally keeping a float copy of it. Raw heightmaps are mapped and
+	// uploaded straight from the mapping, images are decoded.
+	Texture loadHeightmap(const char* path, HeightGrid* heights = nullptr);
+
+	// Vertex and fragment shader sources with defines inserted, ready to compile
+	struct ShaderSources
+	{
+		std::string vertex;
+		std::string fragment;
+	};
+
+	// The file side of loadShaders(), safe to run on any thread
+	ShaderSources readShaders(const char* vertexPath, const char* fragmentPath,
+							  const std::vector<std::string>& defines = {});
+	std::future<ShaderSources> readShadersAsync(const std::string& vertexPath, const std::string& fragmentPath,
+												const std::vector<std::string>& defines = {});
+
+	// Compiles and links read sources, on the GL context's thread
+	Shader createShader(const ShaderSources& sources);
+
+	// Loads a vertex and fragment shader from paths, with each of
+	// defines inserted as a #define right after the #version line
+	Shader loadShaders(const char* vertexPath, const char* fragmentPath,
+					   const std::vector<std::string>& defines = {});
 }
\ No newline at end of file
@@ -64,6 +64,21 @@ void Shader::setFloat(int loc, float value)
 	glUniform1f(loc, value);
 }
 
+void Shader::setVec2(int loc, const glm::vec2& value)
+{
+	glUniform2f(loc, value.x, value.y);
+}
+
+void Shader::setVec3(int loc, const glm::vec3& value)
+{
+	glUniform3f(loc, value.x, value.y, value.z);
+}
+
+void Shader::setIVec2(int loc, const glm::ivec2& value)
+{
+	glUniform2i(loc, value.x, value.y);
+}
+
 void Shader::setMat4(int loc, const glm::mat4& value)
 {
 	glUniformMatrix4fv(loc, 1, false, glm::value_ptr(value));
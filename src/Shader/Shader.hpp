@@ -13,5 +13,8 @@ struct Shader
 
 	void setInt(int loc, int value);
 	void setFloat(int loc, float value);
+	void setVec2(int loc, const glm::vec2& value);
+	void setVec3(int loc, const glm::vec3& value);
+	void setIVec2(int loc, const glm::ivec2& value);
 	void setMat4(int loc, const glm::mat4& value);
 };
\ No newline at end of file
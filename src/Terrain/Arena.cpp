@@ -0,0 +1,90 @@
+#include "Arena.hpp"
+#include <new>
+
+namespace
+{
+	const size_t minBlockSize = 1 << 20;
+}
+
+Arena::Arena(size_t capacity)
+{
+	reserve(capacity);
+}
+
+Arena::~Arena()
+{
+	freeBlocks();
+}
+
+size_t Arena::alignedSize(size_t bytes)
+{
+	return (bytes + Alignment - 1) & ~(Alignment - 1);
+}
+
+void Arena::reserve(size_t bytes)
+{
+	bytes = alignedSize(bytes);
+	if(!blocks.empty() && blocks.back().size - offset >= bytes)
+		return;
+
+	if(used() == 0)
+		freeBlocks();
+	addBlock(bytes);
+}
+
+void Arena::reset()
+{
+	if(blocks.size() > 1)
+	{
+		size_t total = capacity();
+		freeBlocks();
+		addBlock(total);
+	}
+	offset = 0;
+}
+
+void* Arena::allocate(size_t bytes)
+{
+	bytes = alignedSize(bytes);
+	if(blocks.empty() || blocks.back().size - offset < bytes)
+	{
+		size_t grow = blocks.empty() ? minBlockSize : blocks.back().size * 2;
+		addBlock(bytes > grow ? bytes : grow);
+	}
+
+	void* result = blocks.back().data + offset;
+	offset += bytes;
+	return result;
+}
+
+size_t Arena::capacity() const
+{
+	size_t total = 0;
+	for(const Block& block : blocks)
+		total += block.size;
+	return total;
+}
+
+size_t Arena::used() const
+{
+	if(blocks.empty())
+		return 0;
+	return capacity() - blocks.back().size + offset;
+}
+
+void Arena::addBlock(size_t size)
+{
+	Block block;
+	block.data = static_cast<unsigned char*>(::operator new(size, std::align_val_t(Alignment)));
+	block.size = size;
+	blocks.push_back(block);
+	offset = 0;
+}
+
+void Arena::freeBlocks()
+{
+	for(Block& block : blocks)
+		::operator delete(block.data, std::align_val_t(Alignment));
+	blocks.clear();
+	offset = 0;
+}
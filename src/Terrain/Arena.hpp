@@ -0,0 +1,52 @@
+#pragma once
+#include "Span.hpp"
+#include <vector>
+#include <cstddef>
+
+// Bump allocator for transient per-build data. Allocations are only
+// released all at once by reset(), which also merges any overflow blocks
+// so that a rebuild of the same size runs out of a single block.
+struct Arena
+{
+	static constexpr size_t Alignment = 64;
+
+	struct Block
+	{
+		unsigned char* data;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+	size_t offset = 0;
+
+	Arena() = default;
+	explicit Arena(size_t capacity);
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// Rounds a size up to the alignment every allocation starts at
+	static size_t alignedSize(size_t bytes);
+
+	// Makes sure the next bytes worth of allocations fit without touching the heap
+	void reserve(size_t bytes);
+	void reset();
+
+	void* allocate(size_t bytes);
+	size_t capacity() const;
+	size_t used() const;
+
+	template<typename T>
+	Span<T> allocate(size_t count)
+	{
+		Span<T> span;
+		span.data = static_cast<T*>(allocate(count * sizeof(T)));
+		span.size = count;
+		return span;
+	}
+
+private:
+	void addBlock(size_t size);
+	void freeBlocks();
+};
@@ -0,0 +1,167 @@
+#include "Cdlod.hpp"
+#include "HeightGrid.hpp"
+#include <cmath>
+#include <limits>
+
+std::array<VertexAttribute, 2> cdlodInstanceAttributes()
+{
+	size_t stride = sizeof(CdlodInstance);
+	return
+	{{
+		{ 3, 4, AttributeType::Float, false, 0, offsetof(CdlodInstance, row), stride },
+		{ 4, 2, AttributeType::Float, false, 0, offsetof(CdlodInstance, morphStart), stride },
+	}};
+}
+
+void Cdlod::build(const HeightGrid& heights)
+{
+	width = heights.width;
+	height = heights.height;
+	levelCount = 0;
+	nodes.clear();
+	ranges.clear();
+	if(width <= 0 || height <= 0 || patchCells <= 0)
+		return;
+
+	int rootLevel = 0;
+	while(static_cast<long long>(patchCells) << rootLevel < std::max(width, height))
+		rootLevel++;
+	levelCount = rootLevel + 1;
+
+	// Breadth first, so children come after their parents
+	CdlodNode root = {};
+	root.size = patchCells << rootLevel;
+	root.level = rootLevel;
+	nodes.push_back(root);
+	for(size_t n = 0; n < nodes.size(); n++)
+	{
+		CdlodNode parent = nodes[n];
+		if(parent.level == 0)
+			continue;
+
+		int half = parent.size / 2;
+		uint32_t firstChild = static_cast<uint32_t>(nodes.size());
+		for(int dr = 0; dr <= half; dr += half)
+		for(int dc = 0; dc <= half; dc += half)
+		{
+			if(parent.firstRow + dr >= width || parent.firstColumn + dc >= height)
+				continue;
+
+			CdlodNode child = {};
+			child.firstRow = parent.firstRow + dr;
+			child.firstColumn = parent.firstColumn + dc;
+			child.size = half;
+			child.level = parent.level - 1;
+			nodes.push_back(child);
+		}
+
+		nodes[n].firstChild = firstChild;
+		nodes[n].childCount = static_cast<uint32_t>(nodes.size()) - firstChild;
+	}
+
+	// Leaves read their corners, then every parent, which are all
+	// before their children, takes the bounds of its children
+	std::vector<float> cornerHeights = heights.cornerHeights();
+	size_t rowLength = static_cast<size_t>(height + 1);
+	parallelFor(nodes.size(), threadCount, [&](size_t first, size_t last)
+	{
+		for(size_t n = first; n < last; n++)
+		{
+			CdlodNode& node = nodes[n];
+			if(node.childCount > 0)
+				continue;
+
+			node.minHeight = std::numeric_limits<float>::max();
+			node.maxHeight = std::numeric_limits<float>::lowest();
+			int lastRow = std::min(node.firstRow + node.size, width);
+			int lastColumn = std::min(node.firstColumn + node.size, height);
+			for(int i = node.firstRow; i <= lastRow; i++)
+			for(int j = node.firstColumn; j <= lastColumn; j++)
+			{
+				float h = cornerHeights[static_cast<size_t>(i) * rowLength + static_cast<size_t>(j)];
+				node.minHeight = std::min(node.minHeight, h);
+				node.maxHeight = std::max(node.maxHeight, h);
+			}
+		}
+	});
+
+	for(size_t n = nodes.size(); n > 0; n--)
+	{
+		CdlodNode& node = nodes[n - 1];
+		if(node.childCount == 0)
+			continue;
+
+		node.minHeight = std::numeric_limits<float>::max();
+		node.maxHeight = std::numeric_limits<float>::lowest();
+		for(uint32_t k = 0; k < node.childCount; k++)
+		{
+			node.minHeight = std::min(node.minHeight, nodes[node.firstChild + k].minHeight);
+			node.maxHeight = std::max(node.maxHeight, nodes[node.firstChild + k].maxHeight);
+		}
+	}
+
+	// The root is drawn however far away the camera is
+	for(int level = 0; level < levelCount; level++)
+		ranges.push_back(lodDistanceRatio * static_cast<float>(patchCells << level));
+	ranges.back() = std::numeric_limits<float>::max();
+}
+
+bool Cdlod::inRange(const CdlodNode& node, const LodCamera& camera, float range) const
+{
+	float low[3] = { static_cast<float>(node.firstRow), node.minHeight * camera.heightScale, static_cast<float>(node.firstColumn) };
+	float high[3] = { static_cast<float>(std::min(node.firstRow + node.size, width)), node.maxHeight * camera.heightScale,
+					  static_cast<float>(std::min(node.firstColumn + node.size, height)) };
+
+	float distanceSquared = 0.0f;
+	for(int k = 0; k < 3; k++)
+	{
+		float d = std::max(std::max(std::min(low[k], high[k]) - camera.position[k], camera.position[k] - std::max(low[k], high[k])), 0.0f);
+		distanceSquared += d * d;
+	}
+	return distanceSquared <= range * range;
+}
+
+void Cdlod::addInstance(const CdlodNode& node, std::vector<CdlodInstance>& instances) const
+{
+	float range = ranges[node.level];
+	float previousRange = node.level > 0 ? ranges[node.level - 1] : 0.0f;
+
+	CdlodInstance instance;
+	instance.row = static_cast<float>(node.firstRow);
+	instance.column = static_cast<float>(node.firstColumn);
+	instance.cellSize = static_cast<float>(node.size / patchCells);
+	instance.level = static_cast<float>(node.level);
+	instance.morphStart = previousRange + (range - previousRange) * morphStartRatio;
+	instance.morphEnd = range;
+	instances.push_back(instance);
+}
+
+bool Cdlod::selectNode(const CdlodNode& node, const LodCamera& camera, std::vector<CdlodInstance>& instances) const
+{
+	// Out of this level's range, the parent covers the node
+	if(!inRange(node, camera, ranges[node.level]))
+		return false;
+
+	if(node.childCount == 0 || !inRange(node, camera, ranges[node.level - 1]))
+	{
+		addInstance(node, instances);
+		return true;
+	}
+
+	// A child out of its own range is still drawn at its level, but every
+	// corner of it is past the morph end, so it matches this node's grid
+	for(uint32_t k = 0; k < node.childCount; k++)
+	{
+		const CdlodNode& child = nodes[node.firstChild + k];
+		if(!selectNode(child, camera, instances))
+			addInstance(child, instances);
+	}
+	return true;
+}
+
+void Cdlod::select(const LodCamera& camera, std::vector<CdlodInstance>& instances) const
+{
+	instances.clear();
+	if(!nodes.empty())
+		selectNode(nodes[0], camera, instances);
+}
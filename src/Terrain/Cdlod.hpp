@@ -0,0 +1,69 @@
+#pragma once
+#include "ChunkedLod.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct HeightGrid;
+
+// A quadtree node covering size x size grid cells, drawn as one patch
+// whose cells are size / Cdlod::patchCells grid cells wide
+struct CdlodNode
+{
+	int firstRow;		// Grid i of the node's first corner
+	int firstColumn;	// Grid j of the node's first corner
+	int size;			// Grid cells per side, can reach past the grid's edge
+	int level;			// 0 for the finest nodes
+	float minHeight;	// Of the grid corners inside the node, unscaled
+	float maxHeight;
+	uint32_t firstChild;	// Children are stored consecutively
+	uint32_t childCount;	// 0 for leaves
+};
+
+// Per-instance data of a drawn patch, read by basicV.glsl with CDLOD defined
+struct CdlodInstance
+{
+	float row;			// Grid i of the patch's first corner
+	float column;		// Grid j of the patch's first corner
+	float cellSize;		// Grid cells per patch cell
+	float level;
+	float morphStart;	// Camera distance where odd corners start moving onto the next level's grid
+	float morphEnd;		// Camera distance where they get there
+};
+
+// Locations 3 and 4 of basicV.glsl, for a buffer of CdlodInstance
+std::array<VertexAttribute, 2> cdlodInstanceAttributes();
+
+// Continuous distance-dependent LOD after Strugar's "Continuous
+// Distance-Dependent Level of Detail for Rendering Heightmaps". Every node
+// is drawn with the same patchCells x patchCells grid, instanced at the
+// node's position and scale, and the heights come from the heightmap
+// texture. A level is used up to its range from the camera, and its odd
+// corners slide onto the coarser level's grid over the last part of that
+// range, so levels meet without cracks or popping.
+struct Cdlod
+{
+	int patchCells = 32;			// Cells per patch side, even
+	float lodDistanceRatio = 8.0f;	// A level's range, in sizes of its nodes
+	float morphStartRatio = 0.7f;	// Where in its range a level starts to morph
+	unsigned threadCount = 1;
+
+	int width = 0;			// Grid cells along i
+	int height = 0;			// Grid cells along j
+	int levelCount = 0;
+	std::vector<CdlodNode> nodes;	// Root first
+	std::vector<float> ranges;		// Per level, in terrain space units
+
+	// Builds the quadtree, the height bounds of every node and the level ranges
+	void build(const HeightGrid& heights);
+
+	// Replaces instances with the patches to draw for camera. Uses the
+	// camera's position and height scale only, the pixel error is set by
+	// the ranges instead.
+	void select(const LodCamera& camera, std::vector<CdlodInstance>& instances) const;
+
+private:
+	bool selectNode(const CdlodNode& node, const LodCamera& camera, std::vector<CdlodInstance>& instances) const;
+	void addInstance(const CdlodNode& node, std::vector<CdlodInstance>& instances) const;
+	bool inRange(const CdlodNode& node, const LodCamera& camera, float range) const;
+};
@@ -0,0 +1,435 @@
+#include "ChunkedLod.hpp"
+#include "HeightGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+int LodChunk::gridRow(int a) const
+{
+	return std::min(firstRow + a * stride, lastRow);
+}
+
+int LodChunk::gridColumn(int b) const
+{
+	return std::min(firstColumn + b * stride, lastColumn);
+}
+
+size_t LodChunk::vertexCount() const
+{
+	return static_cast<size_t>(rows + 1) * static_cast<size_t>(columns + 1);
+}
+
+float LodCamera::screenError(float geometricError, float distance) const
+{
+	if(distance <= 0.0f)
+		return std::numeric_limits<float>::infinity();
+
+	float projection = viewportHeight / (2.0f * std::tan(0.5f * verticalFov));
+	return geometricError * std::fabs(heightScale) * projection / distance;
+}
+
+static LodChunk makeChunk(int firstRow, int firstColumn, int stride, int level, int cells, int width, int height)
+{
+	int span = cells * stride;
+
+	LodChunk chunk = {};
+	chunk.firstRow = firstRow;
+	chunk.firstColumn = firstColumn;
+	chunk.lastRow = std::min(firstRow + span, width);
+	chunk.lastColumn = std::min(firstColumn + span, height);
+	chunk.rows = (chunk.lastRow - firstRow + stride - 1) / stride;
+	chunk.columns = (chunk.lastColumn - firstColumn + stride - 1) / stride;
+	chunk.stride = stride;
+	chunk.level = level;
+	return chunk;
+}
+
+void ChunkedLod::build(const HeightGrid& heights)
+{
+	width = heights.width;
+	height = heights.height;
+	levelCount = 0;
+	chunks.clear();
+	if(width <= 0 || height <= 0 || chunkCells <= 0)
+		return;
+
+	int rootStride = 1;
+	while(static_cast<long long>(chunkCells) * rootStride < std::max(width, height))
+		rootStride *= 2;
+
+	// Breadth first, so every level is a contiguous range
+	std::vector<size_t> levelStarts;
+	chunks.push_back(makeChunk(0, 0, rootStride, 0, chunkCells, width, height));
+	for(size_t c = 0; c < chunks.size(); c++)
+	{
+		LodChunk parent = chunks[c];
+		if(parent.level == static_cast<int>(levelStarts.size()))
+			levelStarts.push_back(c);
+		if(parent.stride == 1)
+			continue;
+
+		int half = chunkCells * parent.stride / 2;
+		uint32_t firstChild = static_cast<uint32_t>(chunks.size());
+		for(int dr = 0; dr <= half; dr += half)
+		for(int dc = 0; dc <= half; dc += half)
+		{
+			if(parent.firstRow + dr < width && parent.firstColumn + dc < height)
+			{
+				chunks.push_back(makeChunk(parent.firstRow + dr, parent.firstColumn + dc, parent.stride / 2,
+										   parent.level + 1, chunkCells, width, height));
+				chunks.back().parent = static_cast<uint32_t>(c);
+			}
+		}
+
+		chunks[c].firstChild = firstChild;
+		chunks[c].childCount = static_cast<uint32_t>(chunks.size()) - firstChild;
+	}
+	levelCount = static_cast<int>(levelStarts.size());
+	levelStarts.push_back(chunks.size());
+
+	// Deepest level first, so parents can take the largest error of their children
+	std::vector<float> cornerHeights = heights.cornerHeights();
+	for(int level = levelCount - 1; level >= 0; level--)
+	{
+		size_t begin = levelStarts[level];
+		parallelFor(levelStarts[level + 1] - begin, threadCount, [&](size_t first, size_t last)
+		{
+			for(size_t c = begin + first; c < begin + last; c++)
+			{
+				LodChunk& chunk = chunks[c];
+				measure(chunk, cornerHeights);
+				for(uint32_t k = 0; k < chunk.childCount; k++)
+					chunk.geometricError = std::max(chunk.geometricError, chunks[chunk.firstChild + k].geometricError);
+			}
+		});
+	}
+}
+
+void ChunkedLod::measure(LodChunk& chunk, const std::vector<float>& cornerHeights) const
+{
+	size_t rowLength = static_cast<size_t>(height + 1);
+	auto heightAt = [&](int i, int j)
+	{
+		return cornerHeights[static_cast<size_t>(i) * rowLength + static_cast<size_t>(j)];
+	};
+
+	// Every grid corner against the two triangles of the chunk cell it lies
+	// in, split along the same diagonal as the grid's cells. Corners on a
+	// shared cell edge are only visited by the cell before them.
+	float maxError = 0.0f;
+	float minHeight = std::numeric_limits<float>::max();
+	float maxHeight = std::numeric_limits<float>::lowest();
+	for(int a = 0; a < chunk.rows; a++)
+	for(int b = 0; b < chunk.columns; b++)
+	{
+		int r0 = chunk.gridRow(a), r1 = chunk.gridRow(a + 1);
+		int c0 = chunk.gridColumn(b), c1 = chunk.gridColumn(b + 1);
+		int lastI = a + 1 == chunk.rows ? r1 : r1 - 1;
+		int lastJ = b + 1 == chunk.columns ? c1 : c1 - 1;
+
+		float h00 = heightAt(r0, c0), h10 = heightAt(r1, c0);
+		float h01 = heightAt(r0, c1), h11 = heightAt(r1, c1);
+		float du = 1.0f / static_cast<float>(r1 - r0);
+		float dv = 1.0f / static_cast<float>(c1 - c0);
+
+		for(int i = r0; i <= lastI; i++)
+		for(int j = c0; j <= lastJ; j++)
+		{
+			float u = static_cast<float>(i - r0) * du;
+			float v = static_cast<float>(j - c0) * dv;
+			float surface = u >= v ? h00 + u * (h10 - h00) + v * (h11 - h10)
+								   : h00 + v * (h01 - h00) + u * (h11 - h01);
+
+			float h = heightAt(i, j);
+			maxError = std::max(maxError, std::fabs(h - surface));
+			minHeight = std::min(minHeight, h);
+			maxHeight = std::max(maxHeight, h);
+		}
+	}
+
+	chunk.geometricError = chunk.stride == 1 ? 0.0f : maxError;
+	chunk.boundsMin[0] = static_cast<float>(chunk.firstRow);
+	chunk.boundsMin[1] = minHeight;
+	chunk.boundsMin[2] = static_cast<float>(chunk.firstColumn);
+	chunk.boundsMax[0] = static_cast<float>(chunk.lastRow);
+	chunk.boundsMax[1] = maxHeight;
+	chunk.boundsMax[2] = static_cast<float>(chunk.lastColumn);
+}
+
+std::vector<TerrainTile> ChunkedLod::tiles(PrimitiveMode primitive) const
+{
+	primitive = seamPrimitive(primitive);
+	int variants = tilesPerChunk();
+
+	std::vector<TerrainTile> result;
+	result.reserve(chunks.size() * static_cast<size_t>(variants));
+
+	// Shapes are told apart by their cells and stitching variant
+	struct Shape
+	{
+		int rows;
+		int columns;
+		int mask;
+		size_t firstIndex;
+		size_t indexCount;
+	};
+	std::vector<Shape> shapes;
+	std::vector<uint16_t> stitched;
+	size_t vertexCount = 0, indexCount = 0;
+	for(const LodChunk& chunk : chunks)
+	{
+		for(int mask = 0; mask < variants; mask++)
+		{
+			TerrainTile tile;
+			tile.firstRow = chunk.firstRow;
+			tile.firstColumn = chunk.firstColumn;
+			tile.rows = chunk.rows;
+			tile.columns = chunk.columns;
+			tile.baseVertex = vertexCount;
+
+			auto shape = std::find_if(shapes.begin(), shapes.end(), [&](const Shape& s)
+			{
+				return s.rows == tile.rows && s.columns == tile.columns && s.mask == mask;
+			});
+			if(shape == shapes.end())
+			{
+				Shape added = { tile.rows, tile.columns, mask, indexCount, 0 };
+				if(seams == SeamMode::Stitching)
+				{
+					writeStitchedIndices(tile.rows, tile.columns, mask, stitched);
+					added.indexCount = stitched.size();
+				}
+				else
+				{
+					added.indexCount = gridIndexCount(tile.rows, tile.columns, primitive);
+					if(seams == SeamMode::Skirts)
+						added.indexCount += skirtIndexCount(tile.rows, tile.columns, primitive);
+				}
+				indexCount += added.indexCount;
+				shapes.push_back(added);
+				shape = shapes.end() - 1;
+			}
+			tile.firstIndex = shape->firstIndex;
+			tile.indexCount = shape->indexCount;
+
+			result.push_back(tile);
+		}
+		vertexCount += chunkVertexCount(chunk);
+	}
+
+	return result;
+}
+
+size_t ChunkedLod::chunkVertexCount(const LodChunk& chunk) const
+{
+	size_t count = chunk.vertexCount();
+	if(seams == SeamMode::Skirts)
+		count += skirtVertexCount(chunk.rows, chunk.columns);
+	return count;
+}
+
+size_t ChunkedLod::chunkTriangleCount(const LodChunk& chunk) const
+{
+	size_t count = 2 * static_cast<size_t>(chunk.rows) * static_cast<size_t>(chunk.columns);
+	if(seams == SeamMode::Skirts)
+		count += 4 * static_cast<size_t>(chunk.rows + chunk.columns);
+	return count;
+}
+
+float ChunkedLod::chunkScreenError(const LodChunk& chunk, const LodCamera& camera) const
+{
+	if(chunk.geometricError <= 0.0f)
+		return 0.0f;
+	return camera.screenError(chunk.geometricError, boundsDistance(chunk, camera));
+}
+
+float ChunkedLod::skirtDepth(const LodChunk& chunk) const
+{
+	return chunk.geometricError + chunks[0].geometricError;
+}
+
+VertexAttribute morphTargetAttribute()
+{
+	return { 5, 1, AttributeType::HalfFloat, false, 0, 0, sizeof(uint16_t) };
+}
+
+float ChunkedLod::boundsDistance(const LodChunk& chunk, const LodCamera& camera) const
+{
+	float distanceSquared = 0.0f;
+	for(int k = 0; k < 3; k++)
+	{
+		float scale = k == 1 ? camera.heightScale : 1.0f;
+		float low = std::min(chunk.boundsMin[k] * scale, chunk.boundsMax[k] * scale);
+		float high = std::max(chunk.boundsMin[k] * scale, chunk.boundsMax[k] * scale);
+		float d = std::max(std::max(low - camera.position[k], camera.position[k] - high), 0.0f);
+		distanceSquared += d * d;
+	}
+	return std::sqrt(distanceSquared);
+}
+
+float ChunkedLod::morphTarget(const LodChunk& chunk, const HeightGrid& heights, int a, int b) const
+{
+	// The parent has every other corner of its children, and the last ones,
+	// which are clamped to the grid's edge
+	bool oddRow = chunk.level > 0 && (a & 1) && a != chunk.rows;
+	bool oddColumn = chunk.level > 0 && (b & 1) && b != chunk.columns;
+	int a0 = oddRow ? a - 1 : a, a1 = oddRow ? a + 1 : a;
+	int b0 = oddColumn ? b - 1 : b, b1 = oddColumn ? b + 1 : b;
+
+	int i = chunk.gridRow(a), j = chunk.gridColumn(b);
+	int r0 = chunk.gridRow(a0), r1 = chunk.gridRow(a1);
+	int c0 = chunk.gridColumn(b0), c1 = chunk.gridColumn(b1);
+	float h00 = heights.cornerHeight(r0, c0), h10 = heights.cornerHeight(r1, c0);
+	float h01 = heights.cornerHeight(r0, c1), h11 = heights.cornerHeight(r1, c1);
+
+	// Same split of the parent cell as in measure()
+	float u = r1 > r0 ? static_cast<float>(i - r0) / static_cast<float>(r1 - r0) : 0.0f;
+	float v = c1 > c0 ? static_cast<float>(j - c0) / static_cast<float>(c1 - c0) : 0.0f;
+	return u >= v ? h00 + u * (h10 - h00) + v * (h11 - h10)
+				  : h00 + v * (h01 - h00) + u * (h11 - h01);
+}
+
+void ChunkedLod::morphFactors(const LodCamera& camera, float maxPixelError, const std::vector<uint32_t>& selected,
+							  std::vector<float>& morphs) const
+{
+	morphs.resize(selected.size());
+	for(size_t k = 0; k < selected.size(); k++)
+	{
+		const LodChunk& chunk = chunks[selected[k]];
+		if(chunk.level == 0)
+		{
+			morphs[k] = 0.0f;
+			continue;
+		}
+
+		const LodChunk& parent = chunks[chunk.parent];
+		float parentError = camera.screenError(parent.geometricError, boundsDistance(parent, camera));
+		morphs[k] = std::clamp(2.0f - parentError / maxPixelError, 0.0f, 1.0f);
+	}
+}
+
+void ChunkedLod::select(const LodCamera& camera, float maxPixelError, std::vector<uint32_t>& selected) const
+{
+	selected.clear();
+	if(chunks.empty())
+		return;
+
+	// Each visited chunk replaces itself with at most 4 children
+	uint32_t stack[128];
+	size_t top = 0;
+	stack[top++] = 0;
+	while(top > 0)
+	{
+		const LodChunk& chunk = chunks[stack[--top]];
+		if(chunk.childCount == 0 || chunkScreenError(chunk, camera) <= maxPixelError)
+		{
+			selected.push_back(static_cast<uint32_t>(&chunk - chunks.data()));
+			continue;
+		}
+
+		for(uint32_t k = chunk.childCount; k > 0; k--)
+			stack[top++] = chunk.firstChild + k - 1;
+	}
+}
+
+void ChunkedLod::claimSlots(uint32_t c)
+{
+	const LodChunk& chunk = chunks[c];
+	int slotsAlongColumns = (height + chunkCells - 1) / chunkCells;
+	for(int i = chunk.firstRow / chunkCells; i < (chunk.lastRow + chunkCells - 1) / chunkCells; i++)
+	for(int j = chunk.firstColumn / chunkCells; j < (chunk.lastColumn + chunkCells - 1) / chunkCells; j++)
+		slotOwners[static_cast<size_t>(i) * slotsAlongColumns + j] = c;
+}
+
+uint32_t ChunkedLod::slotOwner(int i, int j) const
+{
+	int slotsAlongColumns = (height + chunkCells - 1) / chunkCells;
+	return slotOwners[static_cast<size_t>(i) * slotsAlongColumns + j];
+}
+
+void ChunkedLod::restrictSelection(std::vector<uint32_t>& selected, std::vector<uint8_t>& seamMasks)
+{
+	seamMasks.clear();
+	if(chunks.empty())
+		return;
+
+	// Leaves are chunkCells grid cells wide, so every chunk covers whole slots
+	int slotsAlongRows = (width + chunkCells - 1) / chunkCells;
+	int slotsAlongColumns = (height + chunkCells - 1) / chunkCells;
+	slotOwners.assign(static_cast<size_t>(slotsAlongRows) * slotsAlongColumns, 0);
+	isSelected.assign(chunks.size(), 0);
+	pending.clear();
+	for(uint32_t c : selected)
+	{
+		isSelected[c] = 1;
+		claimSlots(c);
+		pending.push_back(c);
+	}
+
+	// Calls f(i, j) for the slots just outside each side of a chunk, and
+	// gives up on a side as soon as f returns false
+	auto forEachSide = [&](const LodChunk& chunk, auto f)
+	{
+		int i0 = chunk.firstRow / chunkCells, i1 = (chunk.lastRow + chunkCells - 1) / chunkCells;
+		int j0 = chunk.firstColumn / chunkCells, j1 = (chunk.lastColumn + chunkCells - 1) / chunkCells;
+		if(i0 > 0)
+			for(int j = j0; j < j1 && f(SeamFirstRow, i0 - 1, j); j++) {}
+		if(i1 < slotsAlongRows)
+			for(int j = j0; j < j1 && f(SeamLastRow, i1, j); j++) {}
+		if(j0 > 0)
+			for(int i = i0; i < i1 && f(SeamFirstColumn, i, j0 - 1); i++) {}
+		if(j1 < slotsAlongColumns)
+			for(int i = i0; i < i1 && f(SeamLastColumn, i, j1); i++) {}
+	};
+
+	// A neighbour two or more levels coarser is split, and its children are
+	// checked in turn since they can be too coarse for their other neighbours
+	while(!pending.empty())
+	{
+		uint32_t c = pending.back();
+		pending.pop_back();
+		if(!isSelected[c])
+			continue;
+
+		const LodChunk& chunk = chunks[c];
+		bool split = false;
+		forEachSide(chunk, [&](int, int i, int j)
+		{
+			uint32_t n = slotOwner(i, j);
+			if(split || chunks[n].level + 1 >= chunk.level)
+				return !split;
+
+			const LodChunk& neighbour = chunks[n];
+			isSelected[n] = 0;
+			for(uint32_t k = neighbour.firstChild; k < neighbour.firstChild + neighbour.childCount; k++)
+			{
+				isSelected[k] = 1;
+				claimSlots(k);
+				pending.push_back(k);
+			}
+			split = true;
+			return false;
+		});
+		if(split)
+			pending.push_back(c);
+	}
+
+	// A coarser neighbour covers the whole side, so one slot tells
+	selected.clear();
+	for(uint32_t c = 0; c < static_cast<uint32_t>(chunks.size()); c++)
+	{
+		if(!isSelected[c])
+			continue;
+
+		const LodChunk& chunk = chunks[c];
+		uint8_t mask = 0;
+		forEachSide(chunk, [&](int side, int i, int j)
+		{
+			if(chunks[slotOwner(i, j)].level < chunk.level)
+				mask |= static_cast<uint8_t>(side);
+			return false;
+		});
+		selected.push_back(c);
+		seamMasks.push_back(mask);
+	}
+}
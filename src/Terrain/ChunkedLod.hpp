@@ -0,0 +1,280 @@
+#pragma once
+#include "LodSeams.hpp"
+#include "TerrainTiler.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+struct HeightGrid;
+
+// A quadtree node: the grid corners of a square region sampled every
+// stride cells, meshed like a TerrainTiler tile of rows x columns cells.
+// Positions are in terrain space, grid i, height * scale and grid j.
+struct LodChunk
+{
+	int firstRow;		// Grid i of the chunk's first corner
+	int firstColumn;	// Grid j of the chunk's first corner
+	int lastRow;		// Grid i of the chunk's last corner
+	int lastColumn;		// Grid j of the chunk's last corner
+	int rows;			// Chunk cells along i
+	int columns;		// Chunk cells along j
+	int stride;			// Grid cells per chunk cell, 1 for leaves
+	int level;			// 0 for the root
+
+	// Largest vertical distance between the chunk and the full grid, in
+	// heightmap units, and never less than that of any descendant
+	float geometricError;
+
+	// Of the full grid inside the chunk, with unscaled heights
+	float boundsMin[3];
+	float boundsMax[3];
+
+	uint32_t parent;		// 0 for the root
+	uint32_t firstChild;	// Children are stored consecutively
+	uint32_t childCount;	// 0 for leaves
+
+	// Grid i of the chunk's corner row a and grid j of its corner column b.
+	// The last row and column are clamped to the grid's edge.
+	int gridRow(int a) const;
+	int gridColumn(int b) const;
+	size_t vertexCount() const;
+};
+
+// Where the screen-space error of a chunk is measured from
+struct LodCamera
+{
+	float position[3] = { 0.0f, 0.0f, 0.0f };	// In terrain space
+	float heightScale = 1.0f;					// The scale uniform of basicV.glsl
+	float verticalFov = 0.785398f;				// Radians
+	float viewportHeight = 720.0f;				// Pixels
+
+	// Pixels that a vertical error, in heightmap units, covers at distance
+	float screenError(float geometricError, float distance) const;
+};
+
+// Chunked LOD after Ulrich's "Rendering Massive Terrains using Chunked Level
+// of Detail Control". build() cuts the heightmap into a quadtree whose leaves
+// are chunkCells x chunkCells grid cells and whose parents cover four times
+// the area with every other corner left out, up to a root covering the whole
+// grid. Each frame, select() walks down from the root until chunks are
+// within the pixel error. Neighbouring chunks of different levels don't
+// share their edge corners, so the seams between them crack unless seams
+// hides them with skirts or stitches them with restrictSelection().
+struct ChunkedLod
+{
+	// Cells per chunk side, at most TerrainTiler::maxTileCells, at most 253
+	// with skirts, which add vertices, and even for stitching and geomorphs
+	int chunkCells = 64;
+	unsigned threadCount = 1;
+	SeamMode seams = SeamMode::None;
+	bool geomorph = false;	// Build morph targets along with the chunk meshes
+
+	int width = 0;				// Grid cells along i
+	int height = 0;				// Grid cells along j
+	int levelCount = 0;
+	std::vector<LodChunk> chunks;	// Root first, then level by level
+
+	// Builds the quadtree and the error and bounds of every chunk
+	void build(const HeightGrid& heights);
+
+	// Chunks as tiles of one vertex buffer, in the order of chunks. Chunks
+	// with the same number of cells share their indices, so the index buffer
+	// only holds a few tiles' worth. With stitching, chunk c has
+	// tilesPerChunk() tiles, tile c * seamVariantCount + mask being its
+	// stitching variant for mask, and the indices are triangle lists.
+	std::vector<TerrainTile> tiles(PrimitiveMode primitive) const;
+
+	int tilesPerChunk() const
+	{
+		return seams == SeamMode::Stitching ? seamVariantCount : 1;
+	}
+
+	// Stitching variants are only made of triangle lists
+	PrimitiveMode seamPrimitive(PrimitiveMode primitive) const
+	{
+		return seams == SeamMode::Stitching ? PrimitiveMode::Triangles : primitive;
+	}
+
+	// Grid corners, and the skirt vertices below the edges with skirts
+	size_t chunkVertexCount(const LodChunk& chunk) const;
+
+	// Triangles of the chunk's unstitched variant, skirts included, which
+	// stitching only ever lowers
+	size_t chunkTriangleCount(const LodChunk& chunk) const;
+
+	// Pixels of error the chunk shows from camera, infinite with the camera
+	// inside its bounds and 0 for chunks that match the full grid
+	float chunkScreenError(const LodChunk& chunk, const LodCamera& camera) const;
+
+	// How far a chunk's skirt hangs below its edges, in heightmap units. The
+	// crack next to a coarser chunk is at most both chunks' errors, and no
+	// chunk has more error than the root.
+	float skirtDepth(const LodChunk& chunk) const;
+
+	// Replaces selected with the chunks to draw for camera, the coarsest
+	// ones whose error is at most maxPixelError pixels or that are leaves.
+	// Together they cover the grid once.
+	void select(const LodCamera& camera, float maxPixelError, std::vector<uint32_t>& selected) const;
+
+	// Replaces morphs with each selected chunk's blend towards its morph
+	// targets, 1 where its parent would just have been selected instead and
+	// 0 where the parent's error is twice maxPixelError. Set it as the morph
+	// uniform of basicV.glsl with GEOMORPH defined, so a chunk that
+	// replaces its parent starts out looking like it. Neighbours with
+	// different parents can blend by different amounts, and the edges they
+	// share only match where stitched or behind skirts.
+	void morphFactors(const LodCamera& camera, float maxPixelError, const std::vector<uint32_t>& selected,
+					  std::vector<float>& morphs) const;
+
+	// Height of the parent's surface at corner (a, b) of chunk, in heightmap
+	// units. Corners the parent has keep their own height, the others get
+	// the height of the parent triangle they lie in. The root has no parent.
+	float morphTarget(const LodChunk& chunk, const HeightGrid& heights, int a, int b) const;
+
+	// Splits selected chunks until chunks sharing an edge are at most one
+	// level apart, then replaces seamMasks with the SeamSide bits of each
+	// selected chunk's sides that border a coarser chunk.
+	// Reuses internal scratch memory, so it can't be called concurrently.
+	void restrictSelection(std::vector<uint32_t>& selected, std::vector<uint8_t>& seamMasks);
+
+private:
+	// The selected chunk over each leaf-sized square of the grid
+	std::vector<uint32_t> slotOwners;
+	std::vector<uint32_t> pending;
+	std::vector<uint8_t> isSelected;
+
+	void measure(LodChunk& chunk, const std::vector<float>& cornerHeights) const;
+	float boundsDistance(const LodChunk& chunk, const LodCamera& camera) const;
+	void claimSlots(uint32_t c);
+	uint32_t slotOwner(int i, int j) const;
+};
+
+// Location 5 of basicV.glsl with GEOMORPH defined, for the morph target
+// buffer of buildChunkedMesh()
+VertexAttribute morphTargetAttribute();
+
+template<typename Layout>
+size_t chunkedArenaBytes(const TerrainTiler& tiler, const ChunkedLod& lod)
+{
+	std::vector<TerrainTile> tiles = lod.tiles(tiler.grid.primitive);
+
+	size_t vertexCount = 0, indexCount = 0;
+	for(const LodChunk& chunk : lod.chunks)
+		vertexCount += lod.chunkVertexCount(chunk);
+	for(const TerrainTile& tile : tiles)
+		indexCount = std::max(indexCount, tile.firstIndex + tile.indexCount);
+
+	size_t total = Arena::alignedSize(indexCount * sizeof(uint16_t)) +
+				   Arena::alignedSize(tiles.size() * sizeof(TerrainTile));
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		total += Arena::alignedSize(vertexCount * Layout::bufferStride(b));
+	if(lod.geomorph)
+		total += Arena::alignedSize(vertexCount * sizeof(uint16_t));
+	return total;
+}
+
+// Builds the vertices of every chunk and the shared indices of each chunk
+// shape in the given vertex format, with tiler's primitive and vertex cache
+// settings and lod's seams. Tile t of the result is chunk t of lod, or
+// t / seamVariantCount with stitching. Skirts need a layout that can lower
+// a vertex, others get flat skirts that don't hide anything. With
+// geomorph, every vertex also gets its morph target as a half float, with
+// the same offset as the vertex, written in the same pass over the chunks.
+template<typename Layout>
+TiledMeshView<Layout> buildChunkedMesh(const TerrainTiler& tiler, const ChunkedLod& lod, Arena& arena)
+{
+	TiledMeshView<Layout> mesh;
+	mesh.primitive = lod.seamPrimitive(tiler.grid.primitive);
+
+	std::vector<TerrainTile> tiles = lod.tiles(mesh.primitive);
+	if(tiles.empty() || !layoutFitsGrid<Layout>(tiler.grid.width, tiler.grid.height))
+		return mesh;
+
+	if(lod.seams == SeamMode::Skirts && !Layout::carriesHeightOffset)
+		std::cout << "This vertex format can't lower skirt vertices, chunk seams will show cracks" << std::endl;
+
+	size_t indexCount = 0;
+	for(const TerrainTile& tile : tiles)
+		indexCount = std::max(indexCount, tile.firstIndex + tile.indexCount);
+	mesh.vertexCount = tiles.back().baseVertex + lod.chunkVertexCount(lod.chunks.back());
+
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		mesh.buffers[b] = arena.allocate<unsigned char>(mesh.vertexCount * Layout::bufferStride(b));
+	mesh.indices = arena.allocate<uint16_t>(indexCount);
+	mesh.tiles = arena.allocate<TerrainTile>(tiles.size());
+	std::copy(tiles.begin(), tiles.end(), mesh.tiles.data);
+
+	const HeightGrid* heights = tiler.grid.heights;
+	if(lod.geomorph && heights == nullptr)
+		std::cout << "Morph targets need the tiler's heights, building without them" << std::endl;
+	if(lod.geomorph && heights != nullptr)
+		mesh.morphTargets = arena.allocate<uint16_t>(mesh.vertexCount);
+
+	// The first chunk of each shape writes the shape's indices
+	std::vector<size_t> written;
+	std::vector<uint16_t> stitched;
+	int tilesPerChunk = lod.tilesPerChunk();
+	for(size_t t = 0; t < tiles.size(); t++)
+	{
+		const TerrainTile& tile = tiles[t];
+		if(std::find(written.begin(), written.end(), tile.firstIndex) != written.end())
+			continue;
+		written.push_back(tile.firstIndex);
+
+		uint16_t* indices = mesh.indices.data + tile.firstIndex;
+		if(lod.seams == SeamMode::Stitching)
+		{
+			writeStitchedIndices(tile.rows, tile.columns, static_cast<int>(t % tilesPerChunk), stitched);
+			std::copy(stitched.begin(), stitched.end(), indices);
+		}
+		else
+		{
+			tiler.writeTileIndices(tile, indices);
+			if(lod.seams == SeamMode::Skirts)
+				writeSkirtIndices(tile.rows, tile.columns, mesh.primitive, indices + gridIndexCount(tile.rows, tile.columns, mesh.primitive));
+		}
+
+		size_t vertexCount = lod.chunkVertexCount(lod.chunks[t / tilesPerChunk]);
+		if(tiler.vertexCacheSize > 0 && mesh.primitive == PrimitiveMode::Triangles)
+			optimizeVertexCache(indices, tile.indexCount, vertexCount, tiler.vertexCacheSize);
+	}
+
+	unsigned char* buffers[Layout::bufferCount];
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		buffers[b] = mesh.buffers[b].data;
+
+	const bool withHeight = Layout::template has<AttributeRole::Height>;
+	parallelFor(lod.chunks.size(), tiler.grid.threadCount, [&](size_t first, size_t last)
+	{
+		for(size_t c = first; c < last; c++)
+		{
+			const LodChunk& chunk = lod.chunks[c];
+			uint16_t* morphTargets = mesh.morphTargets.empty() ? nullptr : mesh.morphTargets.data;
+			size_t index = tiles[c * tilesPerChunk].baseVertex;
+			for(int a = 0; a <= chunk.rows; a++)
+			for(int b = 0; b <= chunk.columns; b++)
+			{
+				if(morphTargets != nullptr)
+					morphTargets[index] = floatToHalf(lod.morphTarget(chunk, *heights, a, b));
+				Layout::write(buffers, index++, tiler.grid.gridVertex(chunk.gridRow(a), chunk.gridColumn(b), withHeight));
+			}
+
+			if(lod.seams != SeamMode::Skirts)
+				continue;
+
+			float depth = lod.skirtDepth(chunk);
+			for(size_t k = 0; k < skirtVertexCount(chunk.rows, chunk.columns); k++)
+			{
+				int a, b;
+				skirtCorner(chunk.rows, chunk.columns, k, a, b);
+				GridVertex v = tiler.grid.gridVertex(chunk.gridRow(a), chunk.gridColumn(b), withHeight);
+				v.y = -depth;
+				if(morphTargets != nullptr)
+					morphTargets[index] = floatToHalf(lod.morphTarget(chunk, *heights, a, b) + v.y);
+				Layout::write(buffers, index++, v);
+			}
+		}
+	});
+
+	return mesh;
+}
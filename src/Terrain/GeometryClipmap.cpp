@@ -0,0 +1,277 @@
+#include "GeometryClipmap.hpp"
+#include "HeightGrid.hpp"
+#include "TiledHeightfield.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static int wrap(int value, int size)
+{
+	return ((value % size) + size) % size;
+}
+
+// Grid corner of a sample, clamped so windows reaching past the
+// heightmap's edge repeat its border
+static float sampleHeight(const HeightGrid& heights, int r, int c, int spacing)
+{
+	int i = std::clamp(r * spacing, 0, heights.width);
+	int j = std::clamp(c * spacing, 0, heights.height);
+	return heights.cornerHeight(i, j);
+}
+
+// HeightGrid::cornerHeight() of a tiled map, texels wrapping the same way
+static float tiledCornerHeight(TiledHeightfieldReader& tiles, int i, int j)
+{
+	auto texel = [&](int x, int z) { return tiles.sample(wrap(x, tiles.width), wrap(z, tiles.height)); };
+	return 0.25f * (texel(i - 1, j - 1) + texel(i, j - 1) + texel(i - 1, j) + texel(i, j));
+}
+
+void GeometryClipmap::build(const HeightGrid& heights)
+{
+	source = &heights;
+	tiledSource = nullptr;
+	setUpLevels(heights.width, heights.height);
+}
+
+void GeometryClipmap::build(TiledHeightfieldReader& tiles)
+{
+	source = nullptr;
+	tiledSource = &tiles;
+	setUpLevels(tiles.width, tiles.height);
+}
+
+void GeometryClipmap::setUpLevels(int width, int height)
+{
+	levels.clear();
+	updated.clear();
+	samplesUpdated = 0;
+	bytesUpdated = 0;
+
+	int count = levelCount > 0 ? levelCount : levelsToCover(width, height);
+	size_t n = static_cast<size_t>(samples());
+	levels.resize(static_cast<size_t>(count));
+	for(int l = 0; l < count; l++)
+	{
+		ClipmapLevel& level = levels[l];
+		level.spacing = 1 << l;
+		level.originRow = 0;
+		level.originColumn = 0;
+		level.valid = false;
+		level.heights.assign(n * n, 0.0f);
+	}
+}
+
+int GeometryClipmap::levelsToCover(int width, int height) const
+{
+	int count = 1;
+	while(static_cast<long long>(cells) << (count - 1) < 2ll * std::max(width, height))
+		count++;
+	return count;
+}
+
+void GeometryClipmap::update(float row, float column)
+{
+	updated.clear();
+	samplesUpdated = 0;
+
+	int n = samples();
+	for(int l = 0; l < static_cast<int>(levels.size()); l++)
+	{
+		ClipmapLevel& level = levels[l];
+
+		// Origins are even, so every level starts on a sample of the next one
+		float spacing = static_cast<float>(level.spacing);
+		float halfCells = static_cast<float>(cells / 2);
+		int newRow = 2 * static_cast<int>(std::floor((row / spacing - halfCells) * 0.5f));
+		int newColumn = 2 * static_cast<int>(std::floor((column / spacing - halfCells) * 0.5f));
+
+		if(!level.valid || std::abs(newRow - level.originRow) >= n || std::abs(newColumn - level.originColumn) >= n)
+		{
+			sampleRows(l, newRow, newRow + n, newColumn, newColumn + n);
+		}
+		else
+		{
+			// Rows that came into view, across the whole new window
+			if(newRow < level.originRow)
+				sampleRows(l, newRow, level.originRow, newColumn, newColumn + n);
+			else if(newRow > level.originRow)
+				sampleRows(l, level.originRow + n, newRow + n, newColumn, newColumn + n);
+
+			// Columns that came into view, on the rows both windows share
+			int sharedFirst = std::max(newRow, level.originRow);
+			int sharedLast = std::min(newRow, level.originRow) + n;
+			if(newColumn < level.originColumn)
+				sampleRows(l, sharedFirst, sharedLast, newColumn, level.originColumn);
+			else if(newColumn > level.originColumn)
+				sampleRows(l, sharedFirst, sharedLast, level.originColumn + n, newColumn + n);
+		}
+
+		level.originRow = newRow;
+		level.originColumn = newColumn;
+		level.valid = true;
+	}
+
+	bytesUpdated = samplesUpdated * sizeof(float);
+}
+
+void GeometryClipmap::sampleRows(int level, int firstRow, int lastRow, int firstColumn, int lastColumn)
+{
+	if(firstRow >= lastRow || firstColumn >= lastColumn)
+		return;
+
+	ClipmapLevel& clipLevel = levels[level];
+	int n = samples();
+
+	// Split where the rectangle wraps around the buffer's edges
+	int rowStarts[2] = { firstRow, firstRow }, rowCounts[2] = { lastRow - firstRow, 0 };
+	int columnStarts[2] = { firstColumn, firstColumn }, columnCounts[2] = { lastColumn - firstColumn, 0 };
+	int rowSplit = n - wrap(firstRow, n);
+	if(rowSplit < rowCounts[0])
+	{
+		rowStarts[1] = firstRow + rowSplit;
+		rowCounts[1] = rowCounts[0] - rowSplit;
+		rowCounts[0] = rowSplit;
+	}
+	int columnSplit = n - wrap(firstColumn, n);
+	if(columnSplit < columnCounts[0])
+	{
+		columnStarts[1] = firstColumn + columnSplit;
+		columnCounts[1] = columnCounts[0] - columnSplit;
+		columnCounts[0] = columnSplit;
+	}
+
+	for(int rs = 0; rs < 2; rs++)
+	for(int cs = 0; cs < 2; cs++)
+	{
+		if(rowCounts[rs] == 0 || columnCounts[cs] == 0)
+			continue;
+
+		ClipmapRegion region;
+		region.level = level;
+		region.firstRow = wrap(rowStarts[rs], n);
+		region.firstColumn = wrap(columnStarts[cs], n);
+		region.rows = rowCounts[rs];
+		region.columns = columnCounts[cs];
+		updated.push_back(region);
+
+		if(tiledSource != nullptr)
+		{
+			sampleTiled(region, rowStarts[rs], columnStarts[cs], clipLevel.spacing);
+		}
+		else
+		{
+			for(int a = 0; a < region.rows; a++)
+			{
+				float* out = clipLevel.heights.data() + static_cast<size_t>(region.firstRow + a) * n + region.firstColumn;
+				for(int b = 0; b < region.columns; b++)
+					out[b] = sampleHeight(*source, rowStarts[rs] + a, columnStarts[cs] + b, clipLevel.spacing);
+			}
+		}
+		samplesUpdated += static_cast<size_t>(region.rows) * static_cast<size_t>(region.columns);
+	}
+}
+
+void GeometryClipmap::sampleTiled(const ClipmapRegion& region, int firstRow, int firstColumn, int spacing)
+{
+	TiledHeightfieldReader& tiles = *tiledSource;
+	float* heights = levels[region.level].heights.data();
+	int n = samples();
+
+	// A window of a coarser level would read spacing^2 texels per sample
+	if(spacing > 1)
+	{
+		for(int a = 0; a < region.rows; a++)
+		{
+			float* out = heights + static_cast<size_t>(region.firstRow + a) * n + region.firstColumn;
+			int i = std::clamp((firstRow + a) * spacing, 0, tiles.width);
+			for(int b = 0; b < region.columns; b++)
+				out[b] = tiledCornerHeight(tiles, i, std::clamp((firstColumn + b) * spacing, 0, tiles.height));
+		}
+		return;
+	}
+
+	// The texels around every corner of the region, in one pass over its
+	// tiles. Corners on or past the map's edge wrap, which the window can't.
+	HeightGrid window = tiles.readGrid(firstRow - 1, firstColumn - 1, region.rows + 1, region.columns + 1);
+	for(int a = 0; a < region.rows; a++)
+	{
+		float* out = heights + static_cast<size_t>(region.firstRow + a) * n + region.firstColumn;
+		int i = std::clamp(firstRow + a, 0, tiles.width);
+		for(int b = 0; b < region.columns; b++)
+		{
+			int j = std::clamp(firstColumn + b, 0, tiles.height);
+			if(i == 0 || j == 0 || i == tiles.width || j == tiles.height)
+			{
+				out[b] = tiledCornerHeight(tiles, i, j);
+				continue;
+			}
+
+			const float* above = window.texels.data() + static_cast<size_t>(b) * static_cast<size_t>(window.width) + a;
+			const float* below = above + window.width;
+			out[b] = 0.25f * (above[0] + above[1] + below[0] + below[1]);
+		}
+	}
+}
+
+std::vector<unsigned int> GeometryClipmap::indexVariant(int variant) const
+{
+	// The finer level covers half the cells per side, a quarter of the way
+	// in or one cell further along each axis
+	int holeCells = variant > 0 ? cells / 2 : 0;
+	int holeRow = cells / 4 + (variant - 1) / 2;
+	int holeColumn = cells / 4 + (variant - 1) % 2;
+
+	std::vector<unsigned int> indices;
+	indices.reserve(6 * (static_cast<size_t>(cells) * cells - static_cast<size_t>(holeCells) * holeCells));
+
+	// Same corner order and winding as TerrainMeshBuilder
+	unsigned int stride = static_cast<unsigned int>(samples());
+	for(int a = 0; a < cells; a++)
+	for(int b = 0; b < cells; b++)
+	{
+		if(a >= holeRow && a < holeRow + holeCells && b >= holeColumn && b < holeColumn + holeCells)
+			continue;
+
+		unsigned int c = static_cast<unsigned int>(a) * stride + static_cast<unsigned int>(b);
+		unsigned int d = c + stride;
+		indices.insert(indices.end(), { c, d, d + 1, d + 1, c + 1, c });
+	}
+	return indices;
+}
+
+int GeometryClipmap::indexVariantOf(int level) const
+{
+	if(level == 0)
+		return 0;
+
+	// Where the finer level's first sample is, in this level's cells
+	int row = levels[level - 1].originRow / 2 - levels[level].originRow;
+	int column = levels[level - 1].originColumn / 2 - levels[level].originColumn;
+	return 1 + (row - cells / 4) * 2 + (column - cells / 4);
+}
+
+bool validateClipmap(const GeometryClipmap& clipmap, const HeightGrid& heights)
+{
+	int n = clipmap.samples();
+	for(const ClipmapLevel& level : clipmap.levels)
+	{
+		if(!level.valid)
+			continue;
+
+		for(int r = level.originRow; r < level.originRow + n; r++)
+		for(int c = level.originColumn; c < level.originColumn + n; c++)
+		{
+			float stored = level.heights[static_cast<size_t>(wrap(r, n)) * n + wrap(c, n)];
+			if(stored != sampleHeight(heights, r, c, level.spacing))
+				return false;
+		}
+	}
+
+	for(size_t l = 1; l < clipmap.levels.size(); l++)
+	{
+		int variant = clipmap.indexVariantOf(static_cast<int>(l));
+		if(variant < 1 || variant >= GeometryClipmap::indexVariantCount)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+struct HeightGrid;
+struct TiledHeightfieldReader;
+
+// One square window of a geometry clipmap, sampling every spacing-th grid
+// corner. Sample (r, c) is grid corner (r * spacing, c * spacing), stored
+// toroidally at heights[(r mod samples) * samples + (c mod samples)], so a
+// moving window only rewrites the samples that enter it.
+struct ClipmapLevel
+{
+	int spacing;				// Grid cells between samples
+	int originRow;				// Sample r of the window's first row
+	int originColumn;			// Sample c of the window's first column
+	bool valid = false;			// False until the first update
+	std::vector<float> heights;	// samples x samples, unscaled
+};
+
+// A rectangle of a level's buffer rewritten by the last update, in buffer
+// rows and columns, never wrapping around
+struct ClipmapRegion
+{
+	int level;
+	int firstRow;
+	int firstColumn;
+	int rows;
+	int columns;
+};
+
+// Geometry clipmap after Losasso and Hoppe's "Geometry Clipmaps: Terrain
+// Rendering Using Nested Regular Grids". Each level is a cells x cells
+// grid centred on the camera with twice the spacing of the one inside it,
+// so the terrain costs the same however large the heightmap is. Moving the
+// camera only samples the L-shaped strips of each level that come into
+// view, which keeps the per frame update cost proportional to the speed.
+struct GeometryClipmap
+{
+	int cells = 256;		// Cells per level side, a multiple of 4
+	int levelCount = 0;		// 0 for enough levels to cover the grid from anywhere on it
+
+	std::vector<ClipmapLevel> levels;	// Finest first
+	std::vector<ClipmapRegion> updated;	// Regions written by the last update
+
+	// Per update
+	size_t samplesUpdated = 0;
+	size_t bytesUpdated = 0;
+
+	// Sets up the levels, without sampling anything yet
+	void build(const HeightGrid& heights);
+
+	// The same, sampling a tiled heightfield through its tile cache instead,
+	// so the map never has to fit in memory. The finest level reads what
+	// comes into view a window at a time, coarser ones corner by corner.
+	// Samples match build() with the file's HeightGrid.
+	void build(TiledHeightfieldReader& tiles);
+
+	// Levels build() sets up for a width x height grid with levelCount 0.
+	// Each doubling of the grid adds one, and with it that level's strips
+	// to the samples updated per frame.
+	int levelsToCover(int width, int height) const;
+
+	int samples() const
+	{
+		return cells + 1;
+	}
+
+	// Moves every level's window to be centred on grid position (row, column)
+	// and samples what came into view. A level that moved by more than its
+	// size is sampled again in full.
+	void update(float row, float column);
+
+	// Index lists for drawing a level as a triangle list over its samples,
+	// with sample (a, b) of the window as vertex a * samples() + b. Variant 0
+	// has every cell, for the finest level. Variants 1 to 4 leave out the
+	// cells covered by the finer level at each of the places it can sit.
+	static constexpr int indexVariantCount = 5;
+	std::vector<unsigned int> indexVariant(int variant) const;
+	int indexVariantOf(int level) const;
+
+private:
+	const HeightGrid* source = nullptr;
+	TiledHeightfieldReader* tiledSource = nullptr;
+
+	void setUpLevels(int width, int height);
+	void sampleTiled(const ClipmapRegion& region, int firstRow, int firstColumn, int spacing);
+	void sampleRows(int level, int firstRow, int lastRow, int firstColumn, int lastColumn);
+};
+
+// Checks that every sample of every level holds the height of its grid corner
+bool validateClipmap(const GeometryClipmap& clipmap, const HeightGrid& heights);
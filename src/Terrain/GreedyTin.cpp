@@ -0,0 +1,420 @@
+#include "GreedyTin.hpp"
+#include "HeightGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Triangle t owns halfedges 3t, 3t + 1 and 3t + 2, halfedge e runs from
+// triangles[e] to the next point of its triangle. The triangulation layout
+// follows Delaunator; the insertion steps follow mapbox/delatin.
+
+namespace
+{
+	int64_t orient(int ax, int ay, int bx, int by, int cx, int cy)
+	{
+		return static_cast<int64_t>(bx - cx) * (ay - cy) - static_cast<int64_t>(by - cy) * (ax - cx);
+	}
+
+	// Whether p lies inside the circumcircle of a, b, c
+	bool inCircle(int ax, int ay, int bx, int by, int cx, int cy, int px, int py)
+	{
+		int64_t dx = ax - px, dy = ay - py;
+		int64_t ex = bx - px, ey = by - py;
+		int64_t fx = cx - px, fy = cy - py;
+
+		int64_t ap = dx * dx + dy * dy;
+		int64_t bp = ex * ex + ey * ey;
+		int64_t cp = fx * fx + fy * fy;
+
+		return dx * (ey * cp - bp * fy) - dy * (ex * cp - bp * fx) + ap * (ex * fy - ey * fx) < 0;
+	}
+}
+
+GreedyTin::GreedyTin(const HeightGrid& grid)
+	: width(grid.width), height(grid.height), heights(grid.cornerHeights())
+{
+	int p0 = addPoint(0, 0);
+	int p1 = addPoint(height, 0);
+	int p2 = addPoint(0, width);
+	int p3 = addPoint(height, width);
+
+	int t0 = addTriangle(p3, p0, p2, -1, -1, -1);
+	addTriangle(p0, p3, p1, t0, -1, -1);
+	flush();
+}
+
+void GreedyTin::run(float maxError, size_t maxTriangles)
+{
+	while(this->maxError() > maxError && (maxTriangles == 0 || triangleCount() < maxTriangles))
+	{
+		if(!refine())
+			break;
+	}
+}
+
+bool GreedyTin::refine()
+{
+	if(queue.empty() || errors[queue[0]] <= 0.0f)
+		return false;
+
+	int t = queuePop();
+	int e0 = t * 3, e1 = e0 + 1, e2 = e0 + 2;
+	int p0 = triangles[e0], p1 = triangles[e1], p2 = triangles[e2];
+
+	int ax = pointX[p0], ay = pointY[p0];
+	int bx = pointX[p1], by = pointY[p1];
+	int cx = pointX[p2], cy = pointY[p2];
+	int px = candidateX[t], py = candidateY[t];
+
+	int pn = addPoint(px, py);
+
+	if(orient(ax, ay, bx, by, px, py) == 0)
+		handleCollinear(pn, e0);
+	else if(orient(bx, by, cx, cy, px, py) == 0)
+		handleCollinear(pn, e1);
+	else if(orient(cx, cy, ax, ay, px, py) == 0)
+		handleCollinear(pn, e2);
+	else
+	{
+		int h0 = halfedges[e0], h1 = halfedges[e1], h2 = halfedges[e2];
+
+		int t0 = addTriangle(p0, p1, pn, h0, -1, -1, e0);
+		int t1 = addTriangle(p1, p2, pn, h1, -1, t0 + 1);
+		int t2 = addTriangle(p2, p0, pn, h2, t0 + 2, t1 + 1);
+
+		legalize(t0);
+		legalize(t1);
+		legalize(t2);
+	}
+
+	flush();
+	return true;
+}
+
+float GreedyTin::maxError() const
+{
+	return queue.empty() ? 0.0f : errors[queue[0]];
+}
+
+size_t GreedyTin::vertexCount() const
+{
+	return pointX.size();
+}
+
+size_t GreedyTin::triangleCount() const
+{
+	return triangles.size() / 3;
+}
+
+GridTriangulation GreedyTin::triangulation() const
+{
+	GridTriangulation result;
+	result.corners.reserve(pointX.size());
+	for(size_t p = 0; p < pointX.size(); p++)
+		result.corners.push_back(static_cast<unsigned int>(pointY[p] * (height + 1) + pointX[p]));
+
+	// With x and y swapped the triangles already wind like the grid's
+	result.indices.assign(triangles.begin(), triangles.end());
+	return result;
+}
+
+int GreedyTin::addPoint(int x, int y)
+{
+	pointX.push_back(x);
+	pointY.push_back(y);
+	return static_cast<int>(pointX.size()) - 1;
+}
+
+int GreedyTin::addTriangle(int a, int b, int c, int ab, int bc, int ca, int e)
+{
+	// New triangles go at the end, rebuilt ones keep their slot
+	if(e < 0)
+	{
+		e = static_cast<int>(triangles.size());
+		triangles.resize(triangles.size() + 3);
+		halfedges.resize(halfedges.size() + 3);
+		candidateX.push_back(0);
+		candidateY.push_back(0);
+		errors.push_back(0.0f);
+		queueIndices.push_back(-1);
+	}
+
+	int t = e / 3;
+	triangles[e] = a;
+	triangles[e + 1] = b;
+	triangles[e + 2] = c;
+	setHalfedge(e, ab);
+	setHalfedge(e + 1, bc);
+	setHalfedge(e + 2, ca);
+
+	queueIndices[t] = -1;
+	pending.push_back(t);
+	return e;
+}
+
+void GreedyTin::setHalfedge(int a, int b)
+{
+	halfedges[a] = b;
+	if(b >= 0)
+		halfedges[b] = a;
+}
+
+void GreedyTin::flush()
+{
+	for(int t : pending)
+		findCandidate(t);
+	pending.clear();
+}
+
+void GreedyTin::findCandidate(int t)
+{
+	int p0 = triangles[t * 3], p1 = triangles[t * 3 + 1], p2 = triangles[t * 3 + 2];
+	int p0x = pointX[p0], p0y = pointY[p0];
+	int p1x = pointX[p1], p1y = pointY[p1];
+	int p2x = pointX[p2], p2y = pointY[p2];
+
+	int minX = std::min({ p0x, p1x, p2x }), minY = std::min({ p0y, p1y, p2y });
+	int maxX = std::max({ p0x, p1x, p2x }), maxY = std::max({ p0y, p1y, p2y });
+
+	// Edge functions, stepped incrementally over the bounding box
+	int64_t w00 = orient(p1x, p1y, p2x, p2y, minX, minY);
+	int64_t w01 = orient(p2x, p2y, p0x, p0y, minX, minY);
+	int64_t w02 = orient(p0x, p0y, p1x, p1y, minX, minY);
+	int64_t a12 = p2y - p1y, b12 = p1x - p2x;
+	int64_t a20 = p0y - p2y, b20 = p2x - p0x;
+	int64_t a01 = p1y - p0y, b01 = p0x - p1x;
+
+	float area = static_cast<float>(w00 + w01 + w02);
+	float z0 = heightAt(p0x, p0y) / area;
+	float z1 = heightAt(p1x, p1y) / area;
+	float z2 = heightAt(p2x, p2y) / area;
+
+	float maxError = 0.0f;
+	int mx = p0x, my = p0y;
+
+	for(int y = minY; y <= maxY; y++)
+	{
+		// Skip ahead to where the row enters the triangle
+		int64_t dx = 0;
+		if(w00 < 0 && a12 != 0)
+			dx = std::max(dx, -w00 / a12);
+		if(w01 < 0 && a20 != 0)
+			dx = std::max(dx, -w01 / a20);
+		if(w02 < 0 && a01 != 0)
+			dx = std::max(dx, -w02 / a01);
+
+		int64_t w0 = w00 + a12 * dx;
+		int64_t w1 = w01 + a20 * dx;
+		int64_t w2 = w02 + a01 * dx;
+
+		const float* row = heights.data() + static_cast<size_t>(y) * static_cast<size_t>(height + 1);
+		bool wasInside = false;
+		for(int x = minX + static_cast<int>(dx); x <= maxX; x++)
+		{
+			if(w0 >= 0 && w1 >= 0 && w2 >= 0)
+			{
+				wasInside = true;
+
+				float z = z0 * static_cast<float>(w0) + z1 * static_cast<float>(w1) + z2 * static_cast<float>(w2);
+				float dz = std::fabs(z - row[x]);
+				if(dz > maxError)
+				{
+					maxError = dz;
+					mx = x;
+					my = y;
+				}
+			}
+			else if(wasInside)
+				break;
+
+			w0 += a12;
+			w1 += a20;
+			w2 += a01;
+		}
+
+		w00 += b12;
+		w01 += b20;
+		w02 += b01;
+	}
+
+	// The triangle's own points can't be inserted again
+	if((mx == p0x && my == p0y) || (mx == p1x && my == p1y) || (mx == p2x && my == p2y))
+		maxError = 0.0f;
+
+	candidateX[t] = mx;
+	candidateY[t] = my;
+	errors[t] = maxError;
+	queuePush(t);
+}
+
+// Restores the Delaunay property across halfedge a by flipping it, recursively
+void GreedyTin::legalize(int a)
+{
+	int b = halfedges[a];
+	if(b < 0)
+		return;
+
+	int a0 = a - a % 3;
+	int b0 = b - b % 3;
+	int al = a0 + (a + 1) % 3;
+	int ar = a0 + (a + 2) % 3;
+	int bl = b0 + (b + 2) % 3;
+	int br = b0 + (b + 1) % 3;
+
+	int p0 = triangles[ar];
+	int pr = triangles[a];
+	int pl = triangles[al];
+	int p1 = triangles[bl];
+
+	if(!inCircle(pointX[p0], pointY[p0], pointX[pr], pointY[pr], pointX[pl], pointY[pl], pointX[p1], pointY[p1]))
+		return;
+
+	int hal = halfedges[al];
+	int har = halfedges[ar];
+	int hbl = halfedges[bl];
+	int hbr = halfedges[br];
+
+	queueRemove(a0 / 3);
+	queueRemove(b0 / 3);
+
+	int t0 = addTriangle(p0, p1, pl, -1, hbl, hal, a0);
+	int t1 = addTriangle(p1, p0, pr, t0, har, hbr, b0);
+
+	legalize(t0 + 1);
+	legalize(t1 + 2);
+}
+
+// Inserts point p on halfedge a, splitting the triangles on both sides
+void GreedyTin::handleCollinear(int p, int a)
+{
+	int a0 = a - a % 3;
+	int al = a0 + (a + 1) % 3;
+	int ar = a0 + (a + 2) % 3;
+	int p0 = triangles[ar];
+	int pr = triangles[a];
+	int pl = triangles[al];
+	int hal = halfedges[al];
+	int har = halfedges[ar];
+
+	int b = halfedges[a];
+	if(b < 0)
+	{
+		int t0 = addTriangle(p, p0, pr, -1, har, -1, a0);
+		int t1 = addTriangle(p0, p, pl, t0, -1, hal);
+		legalize(t0 + 1);
+		legalize(t1 + 2);
+		return;
+	}
+
+	int b0 = b - b % 3;
+	int bl = b0 + (b + 2) % 3;
+	int br = b0 + (b + 1) % 3;
+	int p1 = triangles[bl];
+	int hbl = halfedges[bl];
+	int hbr = halfedges[br];
+
+	queueRemove(b0 / 3);
+
+	int t0 = addTriangle(p0, pr, p, har, -1, -1, a0);
+	int t1 = addTriangle(pr, p1, p, hbr, -1, t0 + 1, b0);
+	int t2 = addTriangle(p1, pl, p, hbl, -1, t1 + 1);
+	int t3 = addTriangle(pl, p0, p, hal, t0 + 2, t2 + 1);
+
+	legalize(t0);
+	legalize(t1);
+	legalize(t2);
+	legalize(t3);
+}
+
+bool GreedyTin::queueLess(int i, int j) const
+{
+	return errors[queue[i]] > errors[queue[j]];
+}
+
+void GreedyTin::queueSwap(int i, int j)
+{
+	std::swap(queue[i], queue[j]);
+	queueIndices[queue[i]] = i;
+	queueIndices[queue[j]] = j;
+}
+
+void GreedyTin::queuePush(int t)
+{
+	int i = static_cast<int>(queue.size());
+	queueIndices[t] = i;
+	queue.push_back(t);
+	queueUp(i);
+}
+
+int GreedyTin::queuePop()
+{
+	int n = static_cast<int>(queue.size()) - 1;
+	queueSwap(0, n);
+	queueDown(0, n);
+
+	int t = queue.back();
+	queue.pop_back();
+	queueIndices[t] = -1;
+	return t;
+}
+
+void GreedyTin::queueRemove(int t)
+{
+	int i = queueIndices[t];
+	if(i < 0)
+	{
+		// Not scanned yet
+		auto it = std::find(pending.begin(), pending.end(), t);
+		if(it != pending.end())
+		{
+			*it = pending.back();
+			pending.pop_back();
+		}
+		return;
+	}
+
+	int n = static_cast<int>(queue.size()) - 1;
+	if(n != i)
+	{
+		queueSwap(i, n);
+		if(!queueDown(i, n))
+			queueUp(i);
+	}
+
+	queue.pop_back();
+	queueIndices[t] = -1;
+}
+
+void GreedyTin::queueUp(int j)
+{
+	while(j > 0)
+	{
+		int i = (j - 1) >> 1;
+		if(i == j || !queueLess(j, i))
+			break;
+		queueSwap(i, j);
+		j = i;
+	}
+}
+
+// Sifts i0 down within the first n entries, true if it moved
+bool GreedyTin::queueDown(int i0, int n)
+{
+	int i = i0;
+	while(true)
+	{
+		int j1 = 2 * i + 1;
+		if(j1 >= n || j1 < 0)
+			break;
+
+		int j2 = j1 + 1;
+		int j = j1;
+		if(j2 < n && queueLess(j2, j1))
+			j = j2;
+		if(!queueLess(j, i))
+			break;
+
+		queueSwap(i, j);
+		i = j;
+	}
+	return i > i0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "GridTriangulation.hpp"
+#include <cstdint>
+#include <vector>
+
+struct HeightGrid;
+
+// Triangulated irregular network built by greedy insertion, after Garland
+// and Heckbert's "Fast Polygonal Approximation of Terrains and Height Fields".
+// Starts from the two triangles covering the grid and keeps inserting the
+// corner with the largest vertical error into a Delaunay triangulation.
+// Every triangle remembers its worst corner, and only triangles changed by
+// an insertion are rescanned, so a step costs about the area it touches.
+// Works on any heightmap size, only grid corners are ever inserted.
+struct GreedyTin
+{
+	int width = 0;				// Cells along i
+	int height = 0;				// Cells along j
+	std::vector<float> heights;	// Corner heights in TerrainMeshBuilder vertex order
+
+	explicit GreedyTin(const HeightGrid& grid);
+
+	// Inserts corners until the largest error is at most maxError, or the
+	// mesh has reached maxTriangles triangles (0 for no budget)
+	void run(float maxError, size_t maxTriangles = 0);
+
+	// Inserts the worst corner, false if every corner is already exact
+	bool refine();
+
+	// Largest vertical error of the current mesh, in height units
+	float maxError() const;
+
+	size_t vertexCount() const;
+	size_t triangleCount() const;
+
+	// The current mesh, wound like the full grid
+	GridTriangulation triangulation() const;
+
+private:
+	// Points are stored as x = j and y = i, so triangles are scanned
+	// along the contiguous rows of the heights
+	std::vector<int> pointX, pointY;		// Inserted corners
+	std::vector<int> triangles;				// 3 points per triangle
+	std::vector<int> halfedges;				// Opposite halfedge of each triangle edge, -1 on the border
+	std::vector<int> candidateX, candidateY;// Worst corner of each triangle
+	std::vector<float> errors;				// Error at that corner
+	std::vector<int> queue;					// Max-heap of triangles by error
+	std::vector<int> queueIndices;			// Heap position of each triangle, -1 if not queued
+	std::vector<int> pending;				// New triangles that still need a candidate
+
+	float heightAt(int x, int y) const
+	{
+		return heights[static_cast<size_t>(y) * static_cast<size_t>(height + 1) + static_cast<size_t>(x)];
+	}
+
+	int addPoint(int x, int y);
+	int addTriangle(int a, int b, int c, int ab, int bc, int ca, int e = -1);
+	void setHalfedge(int a, int b);
+	void flush();
+	void findCandidate(int t);
+	void legalize(int a);
+	void handleCollinear(int p, int a);
+
+	bool queueLess(int i, int j) const;
+	void queueSwap(int i, int j);
+	void queuePush(int t);
+	int queuePop();
+	void queueRemove(int t);
+	void queueUp(int i);
+	bool queueDown(int i0, int n);
+};
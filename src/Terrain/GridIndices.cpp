@@ -0,0 +1,12 @@
+#include "GridIndices.hpp"
+
+size_t gridIndexCount(int rows, int columns, PrimitiveMode mode)
+{
+	if(rows <= 0 || columns <= 0)
+		return 0;
+
+	if(mode == PrimitiveMode::TriangleStrip)
+		return stripColumnOffset(rows, columns) - 1;
+
+	return static_cast<size_t>(rows) * static_cast<size_t>(columns) * 6;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+
+// How the cells of a terrain grid are turned into indices
+enum class PrimitiveMode
+{
+	Triangles,		// 6 indices per cell
+	TriangleStrip	// One strip per cell column, separated by restart indices
+};
+
+// Largest value of the index type, reserved as the primitive restart index
+template<typename Index>
+constexpr Index restartIndex()
+{
+	return std::numeric_limits<Index>::max();
+}
+
+// Indices for a rows x columns cell grid
+size_t gridIndexCount(int rows, int columns, PrimitiveMode mode);
+
+// Index of the first index of strip column b
+inline size_t stripColumnOffset(int rows, int b)
+{
+	return static_cast<size_t>(b) * (2 * static_cast<size_t>(rows + 1) + 1);
+}
+
+// Writes the strips of cell columns [firstColumn, lastColumn) of a
+// rows x columns grid whose corner (a, b) is vertex a * (columns + 1) + b.
+// Strips run along a and alternate direction, so each one starts next to
+// where the previous ended. They produce the same triangles with the same
+// winding as the triangle list.
+template<typename Index>
+void writeGridStrips(int rows, int columns, int firstColumn, int lastColumn, Index* indices)
+{
+	size_t stride = static_cast<size_t>(columns + 1);
+	indices += stripColumnOffset(rows, firstColumn);
+
+	for(int b = firstColumn; b < lastColumn; b++)
+	{
+		size_t left = static_cast<size_t>(b);
+		if(b % 2 == 0)
+		{
+			for(int a = 0; a <= rows; a++)
+			{
+				size_t row = static_cast<size_t>(a) * stride;
+				*indices++ = static_cast<Index>(row + left + 1);
+				*indices++ = static_cast<Index>(row + left);
+			}
+		}
+		else
+		{
+			for(int a = rows; a >= 0; a--)
+			{
+				size_t row = static_cast<size_t>(a) * stride;
+				*indices++ = static_cast<Index>(row + left);
+				*indices++ = static_cast<Index>(row + left + 1);
+			}
+		}
+
+		if(b + 1 < columns)
+			*indices++ = restartIndex<Index>();
+	}
+}
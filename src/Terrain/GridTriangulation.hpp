@@ -0,0 +1,64 @@
+#pragma once
+#include "VertexLayout.hpp"
+#include <vector>
+
+// Triangle list over a subset of the corners of a TerrainMeshBuilder grid,
+// as produced by the adaptive meshers
+struct GridTriangulation
+{
+	std::vector<unsigned int> corners;	// Grid vertex index i * (height + 1) + j of each vertex
+	std::vector<unsigned int> indices;	// Triangle list into corners, wound like the full grid
+
+	size_t vertexCount() const
+	{
+		return corners.size();
+	}
+
+	size_t triangleCount() const
+	{
+		return indices.size() / 3;
+	}
+};
+
+template<typename Layout>
+size_t triangulationArenaBytes(const GridTriangulation& triangulation)
+{
+	size_t total = Arena::alignedSize(triangulation.indices.size() * sizeof(unsigned int));
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		total += Arena::alignedSize(triangulation.vertexCount() * Layout::bufferStride(b));
+	return total;
+}
+
+// Encodes the triangulation's corners of grid with Layout, giving the
+// same vertex and index buffers buildLayoutMesh() does for the full grid
+template<typename Layout>
+LayoutMeshView<Layout> buildTriangulationMesh(const TerrainMeshBuilder& grid, const GridTriangulation& triangulation, Arena& arena)
+{
+	LayoutMeshView<Layout> mesh;
+	if(!layoutFitsGrid<Layout>(grid.width, grid.height))
+		return mesh;
+
+	mesh.vertexCount = triangulation.vertexCount();
+	mesh.primitive = PrimitiveMode::Triangles;
+
+	unsigned char* buffers[Layout::bufferCount];
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+	{
+		mesh.buffers[b] = arena.allocate<unsigned char>(mesh.vertexCount * Layout::bufferStride(b));
+		buffers[b] = mesh.buffers[b].data;
+	}
+	mesh.indices = arena.allocate<unsigned int>(triangulation.indices.size());
+	std::memcpy(mesh.indices.data, triangulation.indices.data(), mesh.indices.bytes());
+
+	const bool withHeight = Layout::template has<AttributeRole::Height>;
+	unsigned int stride = static_cast<unsigned int>(grid.height + 1);
+	parallelFor(mesh.vertexCount, grid.threadCount, [&](size_t first, size_t last)
+	{
+		for(size_t v = first; v < last; v++)
+		{
+			unsigned int corner = triangulation.corners[v];
+			Layout::write(buffers, v, grid.gridVertex(static_cast<int>(corner / stride), static_cast<int>(corner % stride), withHeight));
+		}
+	});
+	return mesh;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// IEEE 754 binary16 conversion, rounding to nearest even
+inline uint16_t floatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000u;
+	uint32_t exponent = (bits >> 23) & 0xFFu;
+	uint32_t mantissa = bits & 0x7FFFFFu;
+
+	// NaN and infinity
+	if(exponent == 0xFFu)
+		return static_cast<uint16_t>(sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u));
+
+	int halfExponent = static_cast<int>(exponent) - 127 + 15;
+	if(halfExponent >= 31)
+		return static_cast<uint16_t>(sign | 0x7C00u);
+
+	if(halfExponent <= 0)
+	{
+		// Subnormal half or zero
+		if(halfExponent < -10)
+			return static_cast<uint16_t>(sign);
+
+		mantissa |= 0x800000u;
+		uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if(rest > halfway || (rest == halfway && (half & 1u)))
+			half++;
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+	uint32_t rest = mantissa & 0x1FFFu;
+	if(rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+		half++;	// May carry into the exponent, which rounds up correctly
+	return static_cast<uint16_t>(sign | half);
+}
+
+inline float halfToFloat(uint16_t half)
+{
+	uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+	uint32_t exponent = (half >> 10) & 0x1Fu;
+	uint32_t mantissa = half & 0x3FFu;
+
+	uint32_t bits;
+	if(exponent == 0)
+	{
+		if(mantissa == 0)
+			bits = sign;
+		else
+		{
+			// Renormalize the subnormal
+			int e = -1;
+			do
+			{
+				e++;
+				mantissa <<= 1;
+			} while((mantissa & 0x400u) == 0);
+			bits = sign | (static_cast<uint32_t>(127 - 15 - e) << 23) | ((mantissa & 0x3FFu) << 13);
+		}
+	}
+	else if(exponent == 31)
+		bits = sign | 0x7F800000u | (mantissa << 13);
+	else
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
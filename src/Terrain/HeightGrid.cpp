@@ -0,0 +1,47 @@
+#include "HeightGrid.hpp"
+
+HeightGrid::HeightGrid(int width, int height)
+	: width(width), height(height), texels(static_cast<size_t>(width) * static_cast<size_t>(height), 0.0f)
+{
+}
+
+float HeightGrid::texel(int x, int z) const
+{
+	// GL_REPEAT
+	x = ((x % width) + width) % width;
+	z = ((z % height) + height) % height;
+	return texels[static_cast<size_t>(z) * static_cast<size_t>(width) + static_cast<size_t>(x)];
+}
+
+float HeightGrid::cornerHeight(int i, int j) const
+{
+	// Corners sit halfway between texel centers, so linear
+	// filtering weighs the four surrounding texels equally
+	if(i > 0 && j > 0 && i < width && j < height)
+	{
+		const float* above = texels.data() + static_cast<size_t>(j - 1) * static_cast<size_t>(width) + (i - 1);
+		const float* below = above + width;
+		return 0.25f * (above[0] + above[1] + below[0] + below[1]);
+	}
+
+	return 0.25f * (texel(i - 1, j - 1) + texel(i, j - 1) + texel(i - 1, j) + texel(i, j));
+}
+
+std::vector<float> HeightGrid::cornerHeights() const
+{
+	std::vector<float> result;
+	result.reserve(static_cast<size_t>(width + 1) * static_cast<size_t>(height + 1));
+	for(int i = 0; i <= width; i++)
+	for(int j = 0; j <= height; j++)
+		result.push_back(cornerHeight(i, j));
+	return result;
+}
+
+void HeightGrid::displace(float* positions, size_t vertexCount, float scale) const
+{
+	for(size_t v = 0; v < vertexCount; v++)
+	{
+		float* p = positions + v * 3;
+		p[1] = cornerHeight(static_cast<int>(p[0]), static_cast<int>(p[2])) * scale;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// CPU copy of a heightmap's red channel, normalized to [0, 1] for 8 and
+// 16-bit heightmaps and as stored for float ones.
+// Texel (x, z) is what the renderer samples at u = x / width, v = z / height.
+struct HeightGrid
+{
+	int width = 0;
+	int height = 0;
+	std::vector<float> texels;	// Row-major, width texels per row
+
+	HeightGrid() = default;
+	HeightGrid(int width, int height);
+
+	float texel(int x, int z) const;
+
+	// Height of grid corner (i, j) exactly as basicV.glsl samples it:
+	// bilinear filtering at (i / width, j / height) with repeat wrapping
+	float cornerHeight(int i, int j) const;
+
+	// cornerHeight() for every corner, in TerrainMeshBuilder vertex order
+	std::vector<float> cornerHeights() const;
+
+	// Sets y of grid positions (x, y, z per vertex) to cornerHeight() * scale,
+	// giving the displaced surface the vertex shader renders
+	void displace(float* positions, size_t vertexCount, float scale) const;
+};
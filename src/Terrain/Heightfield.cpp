@@ -0,0 +1,65 @@
+#include "Heightfield.hpp"
+#include <cstdint>
+#include <cstring>
+
+size_t heightSampleSize(HeightFormat format)
+{
+	switch(format)
+	{
+	case HeightFormat::UNorm16: return sizeof(uint16_t);
+	case HeightFormat::Float32: return sizeof(float);
+	default: return sizeof(uint8_t);
+	}
+}
+
+float HeightfieldView::sample(int x, int z) const
+{
+	size_t i = static_cast<size_t>(z) * static_cast<size_t>(width) + static_cast<size_t>(x);
+	if(format == HeightFormat::UNorm8)
+		return samples[i] / 255.0f;
+
+	// Samples may not be aligned for their type
+	if(format == HeightFormat::UNorm16)
+	{
+		uint16_t value;
+		std::memcpy(&value, samples + i * sizeof(value), sizeof(value));
+		return value / 65535.0f;
+	}
+
+	float value;
+	std::memcpy(&value, samples + i * sizeof(value), sizeof(value));
+	return value;
+}
+
+HeightGrid HeightfieldView::toHeightGrid() const
+{
+	// One loop per format, the samples are contiguous in both
+	HeightGrid grid(width, height);
+	float* texels = grid.texels.data();
+	size_t count = grid.texels.size();
+	if(format == HeightFormat::UNorm8)
+	{
+		for(size_t i = 0; i < count; i++)
+			texels[i] = samples[i] / 255.0f;
+	}
+	else if(format == HeightFormat::UNorm16)
+	{
+		for(size_t i = 0; i < count; i++)
+		{
+			uint16_t value;
+			std::memcpy(&value, samples + i * sizeof(value), sizeof(value));
+			texels[i] = value / 65535.0f;
+		}
+	}
+	else
+	{
+		std::memcpy(texels, samples, count * sizeof(float));
+	}
+	return grid;
+}
+
+Heightfield::Heightfield(int width, int height, HeightFormat format)
+	: width(width), height(height), format(format),
+	  samples(static_cast<size_t>(width) * static_cast<size_t>(height) * heightSampleSize(format), 0)
+{
+}
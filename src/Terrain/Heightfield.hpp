@@ -0,0 +1,65 @@
+#pragma once
+#include "HeightGrid.hpp"
+#include <cstddef>
+#include <vector>
+
+// Bit depth of a heightmap's single channel
+enum class HeightFormat
+{
+	UNorm8,		// 0 to 255 for [0, 1]
+	UNorm16,	// 0 to 65535 for [0, 1]
+	Float32		// Heights as stored in the file
+};
+
+size_t heightSampleSize(HeightFormat format);
+
+// Single-channel samples owned by someone else, such as a Heightfield or a
+// mapped raw file. Uploads as GL_R8, GL_R16 or GL_R32F.
+struct HeightfieldView
+{
+	int width = 0;
+	int height = 0;
+	HeightFormat format = HeightFormat::UNorm8;
+	const unsigned char* samples = nullptr;	// Row-major, width samples per row
+
+	bool empty() const
+	{
+		return samples == nullptr;
+	}
+
+	size_t byteSize() const
+	{
+		return static_cast<size_t>(width) * static_cast<size_t>(height) * heightSampleSize(format);
+	}
+
+	// Sample (x, z), in [0, 1] for the normalized formats
+	float sample(int x, int z) const;
+
+	// The float copy the meshers and LOD renderers work on, with the
+	// same values the texture gives the shader
+	HeightGrid toHeightGrid() const;
+};
+
+// A heightmap's samples in the file's own precision, one channel, so 8-bit
+// maps take a byte per texel instead of an RGBA8 texel and 16-bit and float
+// survey data keep their precision
+struct Heightfield
+{
+	int width = 0;
+	int height = 0;
+	HeightFormat format = HeightFormat::UNorm8;
+	std::vector<unsigned char> samples;	// Row-major, width samples per row
+
+	Heightfield() = default;
+	Heightfield(int width, int height, HeightFormat format);
+
+	bool empty() const
+	{
+		return samples.empty();
+	}
+
+	HeightfieldView view() const
+	{
+		return { width, height, format, empty() ? nullptr : samples.data() };
+	}
+};
@@ -0,0 +1,175 @@
+#include "LodScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+
+size_t LodScheduler::cost(const ChunkedLod& lod, const LodChunk& chunk) const
+{
+	return budgetKind == LodBudget::Triangles ? lod.chunkTriangleCount(chunk) : lod.chunkVertexCount(chunk);
+}
+
+// Leaves are chunkCells grid cells wide, so every chunk covers whole slots
+void LodScheduler::claimSlots(const ChunkedLod& lod, uint32_t c)
+{
+	const LodChunk& chunk = lod.chunks[c];
+	int slotsAlongColumns = (lod.height + lod.chunkCells - 1) / lod.chunkCells;
+	for(int i = chunk.firstRow / lod.chunkCells; i < (chunk.lastRow + lod.chunkCells - 1) / lod.chunkCells; i++)
+	for(int j = chunk.firstColumn / lod.chunkCells; j < (chunk.lastColumn + lod.chunkCells - 1) / lod.chunkCells; j++)
+		slotOwners[static_cast<size_t>(i) * slotsAlongColumns + j] = c;
+}
+
+bool LodScheduler::gatherSplits(const ChunkedLod& lod, uint32_t c)
+{
+	int slotsAlongRows = (lod.width + lod.chunkCells - 1) / lod.chunkCells;
+	int slotsAlongColumns = (lod.height + lod.chunkCells - 1) / lod.chunkCells;
+
+	stamp++;
+	splits.clear();
+	splits.push_back(c);
+	visited[c] = stamp;
+	for(size_t s = 0; s < splits.size(); s++)
+	{
+		const LodChunk& chunk = lod.chunks[splits[s]];
+		if(chunk.childCount == 0)
+			return false;
+		if(lod.seams != SeamMode::Stitching)
+			continue;
+
+		// Selected chunks are at most a level apart, so only neighbours a
+		// level coarser would end up two levels coarser than the children
+		auto visit = [&](int i, int j)
+		{
+			uint32_t n = slotOwners[static_cast<size_t>(i) * slotsAlongColumns + j];
+			if(lod.chunks[n].level < chunk.level && visited[n] != stamp)
+			{
+				visited[n] = stamp;
+				splits.push_back(n);
+			}
+		};
+		int i0 = chunk.firstRow / lod.chunkCells, i1 = (chunk.lastRow + lod.chunkCells - 1) / lod.chunkCells;
+		int j0 = chunk.firstColumn / lod.chunkCells, j1 = (chunk.lastColumn + lod.chunkCells - 1) / lod.chunkCells;
+		for(int j = j0; j < j1; j++)
+		{
+			if(i0 > 0)
+				visit(i0 - 1, j);
+			if(i1 < slotsAlongRows)
+				visit(i1, j);
+		}
+		for(int i = i0; i < i1; i++)
+		{
+			if(j0 > 0)
+				visit(i, j0 - 1);
+			if(j1 < slotsAlongColumns)
+				visit(i, j1);
+		}
+	}
+	return true;
+}
+
+LodScheduleStats LodScheduler::schedule(const ChunkedLod& lod, const LodCamera& camera, std::vector<uint32_t>& selected)
+{
+	LodScheduleStats stats;
+	selected.clear();
+	heap.clear();
+	if(lod.chunks.empty())
+		return stats;
+
+	int slotsAlongRows = (lod.width + lod.chunkCells - 1) / lod.chunkCells;
+	int slotsAlongColumns = (lod.height + lod.chunkCells - 1) / lod.chunkCells;
+	slotOwners.assign(static_cast<size_t>(slotsAlongRows) * slotsAlongColumns, 0);
+	states.assign(lod.chunks.size(), Unselected);
+	visited.assign(lod.chunks.size(), 0);
+	stamp = 0;
+
+	// Leaves are selected for good, the rest wait in the heap until they're
+	// refined or nothing better fits
+	auto add = [&](uint32_t c)
+	{
+		const LodChunk& chunk = lod.chunks[c];
+		claimSlots(lod, c);
+		float error = lod.chunkScreenError(chunk, camera);
+		if(chunk.childCount == 0 || error <= minPixelError)
+		{
+			states[c] = Selected;
+			return;
+		}
+		states[c] = Queued;
+		heap.push_back({ error, c });
+		std::push_heap(heap.begin(), heap.end());
+	};
+
+	size_t spent = cost(lod, lod.chunks[0]);
+	stats.overBudget = spent > budget;
+	if(!stats.overBudget)
+		add(0);
+	else
+		states[0] = Selected;
+
+	while(!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end());
+		Candidate worst = heap.back();
+		heap.pop_back();
+		if(states[worst.chunk] != Queued)
+			continue;
+
+		// Chunks on the grid's edge are clipped and cheaper to refine, so
+		// one that doesn't fit doesn't end the search. The refinements
+		// stitching forces can reach chunks selected for good, which are
+		// then refined all the same.
+		bool splittable = gatherSplits(lod, worst.chunk);
+		size_t current = 0, refined = 0;
+		for(uint32_t c : splits)
+		{
+			const LodChunk& chunk = lod.chunks[c];
+			current += cost(lod, chunk);
+			for(uint32_t k = 0; k < chunk.childCount; k++)
+				refined += cost(lod, lod.chunks[chunk.firstChild + k]);
+		}
+		if(!splittable || (refined > current && spent + (refined - current) > budget))
+		{
+			states[worst.chunk] = Selected;
+			continue;
+		}
+
+		spent = spent + refined - current;
+		stats.refinements += splits.size();
+		stats.forcedRefinements += splits.size() - 1;
+		for(uint32_t c : splits)
+		{
+			const LodChunk& chunk = lod.chunks[c];
+			states[c] = Refined;
+			for(uint32_t k = 0; k < chunk.childCount; k++)
+				add(chunk.firstChild + k);
+		}
+	}
+
+	stats.pixelErrorReached = minPixelError;
+	double finiteCells = 0.0;
+	for(uint32_t c = 0; c < static_cast<uint32_t>(lod.chunks.size()); c++)
+	{
+		if(states[c] != Selected)
+			continue;
+
+		const LodChunk& chunk = lod.chunks[c];
+		float error = lod.chunkScreenError(chunk, camera);
+		stats.triangles += lod.chunkTriangleCount(chunk);
+		stats.vertices += lod.chunkVertexCount(chunk);
+		selected.push_back(c);
+		if(std::isinf(error))
+		{
+			stats.unboundedChunks++;
+			continue;
+		}
+
+		double cells = static_cast<double>(chunk.lastRow - chunk.firstRow) * (chunk.lastColumn - chunk.firstColumn);
+		stats.maxPixelError = std::max(stats.maxPixelError, error);
+		stats.meanPixelError += error * cells;
+		finiteCells += cells;
+		if(chunk.childCount > 0)
+			stats.pixelErrorReached = std::max(stats.pixelErrorReached, error);
+	}
+	stats.unboundedError = stats.unboundedChunks > 0;
+	if(finiteCells > 0.0)
+		stats.meanPixelError /= finiteCells;
+	return stats;
+}
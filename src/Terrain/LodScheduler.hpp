@@ -0,0 +1,85 @@
+#pragma once
+#include "ChunkedLod.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// What a frame's budget counts
+enum class LodBudget
+{
+	Triangles,	// ChunkedLod::chunkTriangleCount() of the selected chunks
+	Vertices	// ChunkedLod::chunkVertexCount() of the selected chunks
+};
+
+// What one LodScheduler::schedule() picked
+struct LodScheduleStats
+{
+	size_t triangles = 0;
+	size_t vertices = 0;
+	size_t refinements = 0;			// Chunks replaced by their children
+	size_t forcedRefinements = 0;	// Of those, the ones stitching needed for a neighbour
+	float maxPixelError = 0.0f;		// Largest finite screen error of a selected chunk
+	double meanPixelError = 0.0;	// Finite screen error over the grid, each chunk weighted by its cells
+	bool overBudget = false;		// Even the root alone doesn't fit
+
+	// Where the budget stopped refining: the largest finite error of a selected
+	// chunk that has children, minPixelError if there's none. Pass it to
+	// ChunkedLod::morphFactors() to blend like a fixed error selection would.
+	float pixelErrorReached = 0.0f;
+
+	// Chunks with the camera inside their bounds that the budget couldn't
+	// refine. Their error is infinite and left out of the errors above.
+	size_t unboundedChunks = 0;
+	bool unboundedError = false;
+};
+
+// Picks the chunks of a ChunkedLod that fit a fixed cost per frame instead of
+// a fixed pixel error. Starting from the root, the selected chunk with the
+// most screen-space error is replaced by its children while the budget
+// allows, so the error left is spread as evenly as the quadtree can. With
+// stitching, a refinement also splits the neighbours it would leave two
+// levels coarser than its children, and only goes ahead if all of them fit.
+// Each step costs a heap operation on the selected chunks only, so scheduling
+// stays well under a millisecond for thousands of chunks, and it needs no
+// GL, so benches can run it along a camera path.
+struct LodScheduler
+{
+	LodBudget budgetKind = LodBudget::Triangles;
+	size_t budget = 1 << 20;
+	float minPixelError = 0.0f;	// Chunks within it aren't refined, budget left or not
+
+	// Replaces selected with chunks that cover the grid once and together
+	// cost at most budget, unless the root alone is over it. With stitching
+	// they're already restricted, so ChunkedLod::restrictSelection() only
+	// works out their seam masks and doesn't add to the cost.
+	// Reuses internal scratch memory, so it can't be called concurrently.
+	LodScheduleStats schedule(const ChunkedLod& lod, const LodCamera& camera, std::vector<uint32_t>& selected);
+
+private:
+	struct Candidate
+	{
+		float error;
+		uint32_t chunk;
+
+		bool operator<(const Candidate& other) const
+		{
+			return error < other.error;
+		}
+	};
+
+	enum : uint8_t { Unselected, Queued, Selected, Refined };
+
+	std::vector<Candidate> heap;	// Selected chunks that have children, worst first
+	std::vector<uint8_t> states;	// Of every chunk, heap entries of non-Queued ones are stale
+	std::vector<uint32_t> slotOwners;	// The selected chunk over each leaf-sized square
+	std::vector<uint32_t> splits;	// A refinement and the ones it forces
+	std::vector<uint32_t> visited;	// Stamp of the last refinement that reached each chunk
+	uint32_t stamp = 0;
+
+	size_t cost(const ChunkedLod& lod, const LodChunk& chunk) const;
+	void claimSlots(const ChunkedLod& lod, uint32_t c);
+
+	// Gathers c and the refinements stitching forces with it into splits,
+	// false if one of them has no children
+	bool gatherSplits(const ChunkedLod& lod, uint32_t c);
+};
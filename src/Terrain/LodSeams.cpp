@@ -0,0 +1,250 @@
+#include "LodSeams.hpp"
+#include "ChunkedLod.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+size_t skirtVertexCount(int rows, int columns)
+{
+	return 2 * static_cast<size_t>(rows + 1) + 2 * static_cast<size_t>(columns + 1);
+}
+
+void skirtCorner(int rows, int columns, size_t k, int& a, int& b)
+{
+	size_t rowLength = static_cast<size_t>(columns + 1);
+	size_t columnLength = static_cast<size_t>(rows + 1);
+	if(k < 2 * rowLength)
+	{
+		a = k < rowLength ? 0 : rows;
+		b = static_cast<int>(k % rowLength);
+	}
+	else
+	{
+		k -= 2 * rowLength;
+		a = static_cast<int>(k % columnLength);
+		b = k < columnLength ? 0 : columns;
+	}
+}
+
+size_t skirtIndexCount(int rows, int columns, PrimitiveMode mode)
+{
+	if(mode == PrimitiveMode::TriangleStrip)
+		return 2 * skirtVertexCount(rows, columns) + 4;
+	return 12 * static_cast<size_t>(rows + columns);
+}
+
+void writeSkirtIndices(int rows, int columns, PrimitiveMode mode, uint16_t* indices)
+{
+	// Each side as (corner, skirt vertex) pairs: corner index, corner step,
+	// first skirt vertex and count, and whether the wall is wound backwards
+	// to face the same way as the other sides
+	uint16_t rowLength = static_cast<uint16_t>(columns + 1);
+	uint16_t columnLength = static_cast<uint16_t>(rows + 1);
+	uint16_t skirtBase = static_cast<uint16_t>(rowLength * columnLength);
+	struct Side
+	{
+		uint16_t firstCorner;
+		uint16_t step;
+		uint16_t firstSkirt;
+		uint16_t count;
+		bool flip;
+	};
+	const Side sides[4] =
+	{
+		{ 0, 1, skirtBase, rowLength, false },
+		{ static_cast<uint16_t>(rows * rowLength), 1, static_cast<uint16_t>(skirtBase + rowLength), rowLength, true },
+		{ 0, rowLength, static_cast<uint16_t>(skirtBase + 2 * rowLength), columnLength, true },
+		{ static_cast<uint16_t>(columns), rowLength, static_cast<uint16_t>(skirtBase + 2 * rowLength + columnLength), columnLength, false },
+	};
+
+	for(const Side& side : sides)
+	{
+		if(mode == PrimitiveMode::TriangleStrip)
+		{
+			// The tile's strips don't end on a restart index
+			*indices++ = restartIndex<uint16_t>();
+			for(uint16_t k = 0; k < side.count; k++)
+			{
+				uint16_t corner = static_cast<uint16_t>(side.firstCorner + k * side.step);
+				uint16_t skirt = static_cast<uint16_t>(side.firstSkirt + k);
+				*indices++ = side.flip ? corner : skirt;
+				*indices++ = side.flip ? skirt : corner;
+			}
+			continue;
+		}
+
+		for(uint16_t k = 0; k + 1 < side.count; k++)
+		{
+			uint16_t p = static_cast<uint16_t>(side.firstCorner + k * side.step);
+			uint16_t q = static_cast<uint16_t>(p + side.step);
+			uint16_t pSkirt = static_cast<uint16_t>(side.firstSkirt + k);
+			uint16_t qSkirt = static_cast<uint16_t>(pSkirt + 1);
+			if(side.flip)
+			{
+				std::swap(p, q);
+				std::swap(pSkirt, qSkirt);
+			}
+			indices[0] = p;
+			indices[1] = q;
+			indices[2] = qSkirt;
+			indices[3] = qSkirt;
+			indices[4] = pSkirt;
+			indices[5] = p;
+			indices += 6;
+		}
+	}
+}
+
+void writeStitchedIndices(int rows, int columns, int mask, std::vector<uint16_t>& indices)
+{
+	indices.clear();
+	indices.reserve(6 * static_cast<size_t>(rows) * static_cast<size_t>(columns));
+
+	auto corner = [&](int a, int b)
+	{
+		bool rowSide = (a == 0 && (mask & SeamFirstRow)) || (a == rows && (mask & SeamLastRow));
+		bool columnSide = (b == 0 && (mask & SeamFirstColumn)) || (b == columns && (mask & SeamLastColumn));
+		if(rowSide && (b & 1) && b != columns)
+			b--;
+		else if(columnSide && (a & 1) && a != rows)
+			a--;
+		return static_cast<uint16_t>(a * (columns + 1) + b);
+	};
+
+	// The grid's two triangles per cell, less those merging into a line
+	auto triangle = [&](uint16_t p, uint16_t q, uint16_t r)
+	{
+		if(p != q && q != r && r != p)
+			indices.insert(indices.end(), { p, q, r });
+	};
+
+	for(int a = 0; a < rows; a++)
+	for(int b = 0; b < columns; b++)
+	{
+		uint16_t c = corner(a, b), c1 = corner(a, b + 1);
+		uint16_t d = corner(a + 1, b), d1 = corner(a + 1, b + 1);
+		triangle(c, d, d1);
+		triangle(d1, c1, c);
+	}
+}
+
+// Directed edges of a triangle list of corners x * stride + y that no other
+// triangle runs back along, and twice the list's area. False if a triangle
+// isn't wound like the grid.
+static bool collectOpenEdges(const std::vector<unsigned int>& corners, unsigned int stride,
+							 std::unordered_set<unsigned long long>& open, long long& doubleArea)
+{
+	open.clear();
+	doubleArea = 0;
+	for(size_t t = 0; t + 2 < corners.size(); t += 3)
+	{
+		long long x[3], y[3];
+		for(int k = 0; k < 3; k++)
+		{
+			x[k] = corners[t + k] / stride;
+			y[k] = corners[t + k] % stride;
+		}
+		long long cross = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+		if(cross <= 0)
+			return false;
+		doubleArea += cross;
+
+		for(int e = 0; e < 3; e++)
+		{
+			unsigned long long u = corners[t + e];
+			unsigned long long v = corners[t + (e + 1) % 3];
+			if(open.erase((v << 32) | u) == 0)
+				open.insert((u << 32) | v);
+		}
+	}
+	return corners.size() % 3 == 0;
+}
+
+bool validateStitchVariants(int rows, int columns)
+{
+	unsigned int stride = static_cast<unsigned int>(columns + 1);
+	std::vector<uint16_t> indices;
+	std::vector<unsigned int> corners;
+	std::unordered_set<unsigned long long> open, expected;
+	for(int mask = 0; mask < seamVariantCount; mask++)
+	{
+		writeStitchedIndices(rows, columns, mask, indices);
+		corners.assign(indices.begin(), indices.end());
+
+		long long doubleArea;
+		if(!collectOpenEdges(corners, stride, open, doubleArea) || doubleArea != 2ll * rows * columns)
+			return false;
+
+		// Undirected edges between the corners each side keeps
+		expected.clear();
+		auto expectSide = [&](bool stitched, int length, auto cornerAt)
+		{
+			int previous = 0;
+			for(int k = 1; k <= length; k++)
+			{
+				if(stitched && (k & 1) && k != length)
+					continue;
+				unsigned long long u = cornerAt(previous), v = cornerAt(k);
+				expected.insert((std::min(u, v) << 32) | std::max(u, v));
+				previous = k;
+			}
+		};
+		expectSide(mask & SeamFirstRow, columns, [&](int b) { return static_cast<unsigned int>(b); });
+		expectSide(mask & SeamLastRow, columns, [&](int b) { return static_cast<unsigned int>(rows) * stride + b; });
+		expectSide(mask & SeamFirstColumn, rows, [&](int a) { return static_cast<unsigned int>(a) * stride; });
+		expectSide(mask & SeamLastColumn, rows, [&](int a) { return static_cast<unsigned int>(a) * stride + columns; });
+
+		if(open.size() != expected.size())
+			return false;
+		for(unsigned long long edge : open)
+		{
+			unsigned long long u = edge >> 32, v = edge & 0xffffffffull;
+			if(expected.count((std::min(u, v) << 32) | std::max(u, v)) == 0)
+				return false;
+		}
+	}
+	return true;
+}
+
+bool validateGridWatertight(const std::vector<unsigned int>& corners, int width, int height)
+{
+	if(width <= 0 || height <= 0)
+		return false;
+
+	unsigned int stride = static_cast<unsigned int>(height + 1);
+	std::unordered_set<unsigned long long> open;
+	long long doubleArea;
+	if(!collectOpenEdges(corners, stride, open, doubleArea))
+		return false;
+
+	// What's left open has to run along the grid's border
+	for(unsigned long long edge : open)
+	{
+		long long ux = static_cast<long long>(edge >> 32) / stride, uy = static_cast<long long>(edge >> 32) % stride;
+		long long vx = static_cast<long long>(edge & 0xffffffffull) / stride, vy = static_cast<long long>(edge & 0xffffffffull) % stride;
+		bool border = (ux == vx && (ux == 0 || ux == width)) || (uy == vy && (uy == 0 || uy == height));
+		if(!border)
+			return false;
+	}
+	return doubleArea == 2ll * width * height;
+}
+
+bool validateChunkSeams(const ChunkedLod& lod, const std::vector<uint32_t>& selected, const std::vector<uint8_t>& seamMasks)
+{
+	if(selected.size() != seamMasks.size())
+		return false;
+
+	std::vector<unsigned int> corners;
+	std::vector<uint16_t> indices;
+	unsigned int stride = static_cast<unsigned int>(lod.height + 1);
+	for(size_t k = 0; k < selected.size(); k++)
+	{
+		const LodChunk& chunk = lod.chunks[selected[k]];
+		writeStitchedIndices(chunk.rows, chunk.columns, seamMasks[k], indices);
+		for(uint16_t index : indices)
+		{
+			int a = index / (chunk.columns + 1), b = index % (chunk.columns + 1);
+			corners.push_back(static_cast<unsigned int>(chunk.gridRow(a)) * stride + static_cast<unsigned int>(chunk.gridColumn(b)));
+		}
+	}
+	return validateGridWatertight(corners, lod.width, lod.height);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "GridIndices.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ChunkedLod;
+
+// How tiles of different resolution meet. Where a tile borders a coarser
+// one, every other corner of its edge has no counterpart across the seam,
+// and the T-junctions there open into cracks.
+enum class SeamMode
+{
+	None,
+	Skirts,		// Each tile hangs a vertical strip below its edges, needs no neighbour knowledge
+	Stitching	// Edges next to a coarser tile skip their odd corners, one index variant per combination
+};
+
+// Sides of a rows x columns tile that border a tile of half its resolution,
+// combined into the bits of a stitching variant
+enum SeamSide
+{
+	SeamFirstRow = 1,		// Corners (0, b)
+	SeamLastRow = 2,		// Corners (rows, b)
+	SeamFirstColumn = 4,	// Corners (a, 0)
+	SeamLastColumn = 8		// Corners (a, columns)
+};
+
+constexpr int seamVariantCount = 16;
+
+// Skirt vertices follow the tile's (rows + 1) x (columns + 1) corners: the
+// first row's corners, the last row's, the first column's and the last
+// column's, each in order. Skirt vertex k sits below corner (a, b).
+size_t skirtVertexCount(int rows, int columns);
+void skirtCorner(int rows, int columns, size_t k, int& a, int& b);
+
+// Indices of the skirts' walls, to follow the tile's own indices. Strips
+// get one strip per side, each after a restart index.
+size_t skirtIndexCount(int rows, int columns, PrimitiveMode mode);
+void writeSkirtIndices(int rows, int columns, PrimitiveMode mode, uint16_t* indices);
+
+// Triangle list of a rows x columns tile whose odd corners on the sides in
+// mask are merged into the corner before them, so those sides only use the
+// corners a tile of half the resolution has. The last corner of a side is
+// always kept, since a clipped coarser neighbour ends on it too. Replaces
+// indices, in the tile's own corner order and winding.
+void writeStitchedIndices(int rows, int columns, int mask, std::vector<uint16_t>& indices);
+
+// Checks every stitching variant of a rows x columns tile: all triangles
+// are wound like the grid, they cover the tile once, and each side's open
+// edges are exactly those of a neighbour of the same or half the
+// resolution, so the tile is watertight against either
+bool validateStitchVariants(int rows, int columns);
+
+// Checks that a triangle list of grid corners i * (height + 1) + j covers the
+// width x height grid exactly once without cracks: every triangle is wound
+// like the grid and every edge inside the grid is shared by two triangles
+bool validateGridWatertight(const std::vector<unsigned int>& corners, int width, int height);
+
+// Stitches lod's selected chunks with their variants from seamMasks, as
+// ChunkedLod::restrictSelection() gives them, and checks the result with
+// validateGridWatertight()
+bool validateChunkSeams(const ChunkedLod& lod, const std::vector<uint32_t>& selected, const std::vector<uint8_t>& seamMasks);
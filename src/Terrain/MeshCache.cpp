@@ -0,0 +1,140 @@
+#include "MeshCache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const char meshCacheMagic[4] = { 'I', 'T', 'T', 'M' };
+
+static uint64_t sectionStart(uint64_t offset)
+{
+	return (offset + 63) / 64 * 64;
+}
+
+void MeshCacheHasher::add(const void* data, size_t bytes)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	for(; bytes >= sizeof(uint64_t); bytes -= sizeof(uint64_t), p += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, p, sizeof(word));
+		value = (value ^ word) * 1099511628211ull;
+		value ^= value >> 32;
+	}
+	for(; bytes > 0; bytes--, p++)
+		value = (value ^ *p) * 1099511628211ull;
+}
+
+uint64_t meshCacheKey(uint64_t layoutHash, const TerrainTiler& tiler, const ChunkedLod* lod)
+{
+	MeshCacheHasher hash;
+	hash.addValue(layoutHash);
+	hash.addValue(tiler.grid.width);
+	hash.addValue(tiler.grid.height);
+	hash.addValue(tiler.grid.primitive);
+	hash.addValue(tiler.tileCells);
+	hash.addValue(tiler.vertexCacheSize);
+
+	const HeightGrid* heights = tiler.grid.heights;
+	hash.addValue(heights != nullptr);
+	if(heights != nullptr)
+	{
+		hash.addValue(heights->width);
+		hash.addValue(heights->height);
+		hash.add(heights->texels.data(), heights->texels.size() * sizeof(float));
+	}
+
+	hash.addValue(lod != nullptr);
+	if(lod != nullptr)
+	{
+		hash.addValue(lod->chunkCells);
+		hash.addValue(lod->seams);
+		hash.addValue(lod->geomorph);
+	}
+	return hash.value;
+}
+
+bool writeMeshCacheFile(const char* path, uint64_t key, PrimitiveMode primitive, size_t vertexCount,
+						const Span<const unsigned char>* sections, size_t sectionCount)
+{
+	MeshCacheHeader header;
+	std::memcpy(header.magic, meshCacheMagic, sizeof(meshCacheMagic));
+	header.version = meshCacheVersion;
+	header.key = key;
+	header.vertexCount = vertexCount;
+	header.primitive = static_cast<uint32_t>(primitive);
+	header.sectionCount = static_cast<uint32_t>(sectionCount);
+	header.tileBytes = sizeof(TerrainTile);
+	header.reserved = 0;
+
+	std::vector<MeshCacheSection> table(sectionCount);
+	uint64_t offset = sizeof(header) + sectionCount * sizeof(MeshCacheSection);
+	for(size_t s = 0; s < sectionCount; s++)
+	{
+		offset = sectionStart(offset);
+		table[s].offset = offset;
+		table[s].bytes = sections[s].size;
+		offset += sections[s].size;
+	}
+
+	std::string temporary = std::string(path) + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary);
+		if(!file)
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(MeshCacheSection)));
+
+		const char padding[64] = {};
+		for(size_t s = 0; s < sectionCount; s++)
+		{
+			uint64_t position = static_cast<uint64_t>(file.tellp());
+			file.write(padding, static_cast<std::streamsize>(table[s].offset - position));
+			file.write(reinterpret_cast<const char*>(sections[s].data), static_cast<std::streamsize>(sections[s].size));
+		}
+		if(!file)
+			return false;
+	}
+
+	std::remove(path);
+	return std::rename(temporary.c_str(), path) == 0;
+}
+
+bool mapMeshCacheFile(const char* path, uint64_t key, MappedFile& file, PrimitiveMode& primitive, size_t& vertexCount,
+					  Span<const unsigned char>* sections, size_t sectionCount)
+{
+	if(!file.open(path))
+		return false;
+
+	MeshCacheHeader header;
+	size_t tableEnd = sizeof(header) + sectionCount * sizeof(MeshCacheSection);
+	bool valid = file.size >= tableEnd;
+	if(valid)
+	{
+		std::memcpy(&header, file.data, sizeof(header));
+		valid = std::memcmp(header.magic, meshCacheMagic, sizeof(meshCacheMagic)) == 0 && header.version == meshCacheVersion &&
+				header.key == key && header.sectionCount == sectionCount && header.tileBytes == sizeof(TerrainTile);
+	}
+
+	for(size_t s = 0; s < sectionCount && valid; s++)
+	{
+		MeshCacheSection section;
+		std::memcpy(&section, file.data + sizeof(header) + s * sizeof(section), sizeof(section));
+		valid = section.offset >= tableEnd && section.offset <= file.size && section.bytes <= file.size - section.offset;
+		sections[s] = { file.data + section.offset, static_cast<size_t>(section.bytes) };
+	}
+
+	if(!valid)
+	{
+		file.close();
+		return false;
+	}
+
+	// Uploading reads every section front to back once
+	file.advise(MappedAccess::Sequential);
+	primitive = static_cast<PrimitiveMode>(header.primitive);
+	vertexCount = static_cast<size_t>(header.vertexCount);
+	return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "ChunkedLod.hpp"
+#include "HeightGrid.hpp"
+#include "TerrainTiler.hpp"
+#include "../Util/MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Mesh cache files hold a TiledMeshView's buffers ready to upload, so a
+// heightmap that was meshed before is mapped instead of meshed again. The
+// header is followed by one MeshCacheSection per buffer: the layout's
+// vertex buffers, the indices, the tiles and the morph targets, each
+// starting at a multiple of 64 bytes.
+struct MeshCacheHeader
+{
+	char magic[4];			// "ITTM"
+	uint32_t version;		// meshCacheVersion
+	uint64_t key;			// meshCacheKey() of what the mesh was built from
+	uint64_t vertexCount;
+	uint32_t primitive;		// A PrimitiveMode
+	uint32_t sectionCount;
+	uint32_t tileBytes;		// sizeof(TerrainTile) of the writer
+	uint32_t reserved;
+};
+
+struct MeshCacheSection
+{
+	uint64_t offset;	// From the start of the file
+	uint64_t bytes;
+};
+
+constexpr uint32_t meshCacheVersion = 1;
+
+// 64-bit FNV-1a over eight bytes at a time, with a shift that lets high
+// bits reach the low ones. Not cryptographic, only for telling inputs apart.
+struct MeshCacheHasher
+{
+	uint64_t value = 14695981039346656037ull;
+
+	void add(const void* data, size_t bytes);
+
+	template<typename T>
+	void addValue(const T& v)
+	{
+		add(&v, sizeof(v));
+	}
+
+	template<typename Layout>
+	void addLayout()
+	{
+		addValue(Layout::bufferCount);
+		for(const VertexAttribute& attribute : Layout::attributes())
+		{
+			addValue(attribute.location);
+			addValue(attribute.components);
+			addValue(attribute.type);
+			addValue(attribute.normalized);
+			addValue(attribute.buffer);
+			addValue(attribute.offset);
+			addValue(attribute.stride);
+		}
+	}
+};
+
+// Everything a tiled or chunked mesh is built from: the vertex format, the
+// tiler's grid, primitive and vertex cache settings, the heights when the
+// tiler bakes them, and lod's settings for chunked meshes
+uint64_t meshCacheKey(uint64_t layoutHash, const TerrainTiler& tiler, const ChunkedLod* lod);
+
+template<typename Layout>
+uint64_t meshCacheKey(const TerrainTiler& tiler, const ChunkedLod* lod = nullptr)
+{
+	MeshCacheHasher layout;
+	layout.addLayout<Layout>();
+	return meshCacheKey(layout.value, tiler, lod);
+}
+
+// Writes sections to path through a temporary file, so an interrupted write
+// never leaves a cache behind. False if it can't be written.
+bool writeMeshCacheFile(const char* path, uint64_t key, PrimitiveMode primitive, size_t vertexCount,
+						const Span<const unsigned char>* sections, size_t sectionCount);
+
+// Maps path into file and points sections into it, false unless it's a
+// cache of this version for key with sectionCount sections
+bool mapMeshCacheFile(const char* path, uint64_t key, MappedFile& file, PrimitiveMode& primitive, size_t& vertexCount,
+					  Span<const unsigned char>* sections, size_t sectionCount);
+
+template<typename T>
+Span<const unsigned char> meshCacheBytes(const Span<T>& span)
+{
+	return { reinterpret_cast<const unsigned char*>(span.data), span.bytes() };
+}
+
+template<typename T>
+Span<T> meshCacheSpan(const Span<const unsigned char>& bytes)
+{
+	// The mapping is read-only, the views only ever get uploaded
+	return { reinterpret_cast<T*>(const_cast<unsigned char*>(bytes.data)), bytes.size / sizeof(T) };
+}
+
+template<typename Layout>
+bool saveMeshCache(const char* path, uint64_t key, const TiledMeshView<Layout>& mesh)
+{
+	Span<const unsigned char> sections[Layout::bufferCount + 3];
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		sections[b] = meshCacheBytes(mesh.buffers[b]);
+	sections[Layout::bufferCount] = meshCacheBytes(mesh.indices);
+	sections[Layout::bufferCount + 1] = meshCacheBytes(mesh.tiles);
+	sections[Layout::bufferCount + 2] = meshCacheBytes(mesh.morphTargets);
+	return writeMeshCacheFile(path, key, mesh.primitive, mesh.vertexCount, sections, Layout::bufferCount + 3);
+}
+
+// Replaces mesh with views into the cache at path, mapped into file, which
+// has to outlive them. False, leaving mesh alone, if there's no cache for key.
+template<typename Layout>
+bool loadMeshCache(const char* path, uint64_t key, MappedFile& file, TiledMeshView<Layout>& mesh)
+{
+	Span<const unsigned char> sections[Layout::bufferCount + 3];
+	PrimitiveMode primitive;
+	size_t vertexCount;
+	if(!mapMeshCacheFile(path, key, file, primitive, vertexCount, sections, Layout::bufferCount + 3))
+		return false;
+
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		mesh.buffers[b] = meshCacheSpan<unsigned char>(sections[b]);
+	mesh.indices = meshCacheSpan<uint16_t>(sections[Layout::bufferCount]);
+	mesh.tiles = meshCacheSpan<TerrainTile>(sections[Layout::bufferCount + 1]);
+	mesh.morphTargets = meshCacheSpan<uint16_t>(sections[Layout::bufferCount + 2]);
+	mesh.vertexCount = vertexCount;
+	mesh.primitive = primitive;
+	return true;
+}
@@ -0,0 +1,239 @@
+#include "Meshlets.hpp"
+#include "../Util/Parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+	void computeBounds(Meshlet& meshlet, const MeshletTable& table, const float* positions)
+	{
+		const uint32_t* vertices = table.vertices.data() + meshlet.vertexOffset;
+		const uint8_t* triangles = table.triangles.data() + meshlet.triangleOffset;
+
+		// Sphere around the vertex centroid
+		double center[3] = { 0.0, 0.0, 0.0 };
+		for(uint32_t v = 0; v < meshlet.vertexCount; v++)
+			for(int c = 0; c < 3; c++)
+				center[c] += positions[vertices[v] * 3 + c];
+		for(int c = 0; c < 3; c++)
+			meshlet.center[c] = static_cast<float>(center[c] / meshlet.vertexCount);
+
+		float radiusSquared = 0.0f;
+		for(uint32_t v = 0; v < meshlet.vertexCount; v++)
+		{
+			float distanceSquared = 0.0f;
+			for(int c = 0; c < 3; c++)
+			{
+				float d = positions[vertices[v] * 3 + c] - meshlet.center[c];
+				distanceSquared += d * d;
+			}
+			radiusSquared = std::max(radiusSquared, distanceSquared);
+		}
+		meshlet.radius = std::sqrt(radiusSquared);
+
+		// Normal cone around the average triangle normal
+		std::vector<std::array<float, 3>> normals;
+		normals.reserve(meshlet.triangleCount);
+		float axis[3] = { 0.0f, 0.0f, 0.0f };
+		for(uint32_t t = 0; t < meshlet.triangleCount; t++)
+		{
+			const float* p0 = positions + vertices[triangles[t * 3]] * 3;
+			const float* p1 = positions + vertices[triangles[t * 3 + 1]] * 3;
+			const float* p2 = positions + vertices[triangles[t * 3 + 2]] * 3;
+
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			std::array<float, 3> n = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+			float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if(length == 0.0f)
+				continue;
+
+			for(int c = 0; c < 3; c++)
+			{
+				n[c] /= length;
+				axis[c] += n[c];
+			}
+			normals.push_back(n);
+		}
+
+		float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if(normals.empty() || axisLength == 0.0f)
+		{
+			meshlet.coneAxis[0] = 0.0f;
+			meshlet.coneAxis[1] = 1.0f;
+			meshlet.coneAxis[2] = 0.0f;
+			meshlet.coneCutoff = 1.0f;
+			return;
+		}
+
+		for(int c = 0; c < 3; c++)
+			meshlet.coneAxis[c] = axis[c] / axisLength;
+
+		float minDot = 1.0f;
+		for(const std::array<float, 3>& n : normals)
+			minDot = std::min(minDot, n[0] * meshlet.coneAxis[0] + n[1] * meshlet.coneAxis[1] + n[2] * meshlet.coneAxis[2]);
+
+		// Cones of 90 degrees or more can't prove anything is backfacing
+		meshlet.coneCutoff = minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+	}
+
+	// Triangle as global vertex indices, rotated so the smallest comes first
+	std::array<uint32_t, 3> canonicalTriangle(uint32_t a, uint32_t b, uint32_t c)
+	{
+		if(b < a && b < c)
+			return { b, c, a };
+		if(c < a && c < b)
+			return { c, a, b };
+		return { a, b, c };
+	}
+}
+
+bool Meshlet::isBackfacing(const float cameraPosition[3]) const
+{
+	float d[3] = { center[0] - cameraPosition[0], center[1] - cameraPosition[1], center[2] - cameraPosition[2] };
+	float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+	return d[0] * coneAxis[0] + d[1] * coneAxis[1] + d[2] * coneAxis[2] >= coneCutoff * distance + radius;
+}
+
+size_t MeshletTable::byteSize() const
+{
+	return meshlets.size() * sizeof(Meshlet) + vertices.size() * sizeof(uint32_t) + triangles.size();
+}
+
+template<typename Index>
+void MeshletBuilder::build(const float* positions, const Index* indices, size_t indexCount, size_t baseVertex, MeshletTable& table) const
+{
+	size_t vertexLimit = std::min<size_t>(maxVertices, 256);
+	size_t triangleLimit = maxTriangles;
+
+	// Meshlet-local index of each vertex in the meshlet being filled, -1 if absent
+	Index maxIndex = 0;
+	for(size_t k = 0; k < indexCount; k++)
+		maxIndex = std::max(maxIndex, indices[k]);
+	std::vector<int> local(static_cast<size_t>(maxIndex) + 1, -1);
+
+	Meshlet current = {};
+	current.vertexOffset = static_cast<uint32_t>(table.vertices.size());
+	current.triangleOffset = static_cast<uint32_t>(table.triangles.size());
+
+	auto finish = [&]()
+	{
+		if(current.triangleCount == 0)
+			return;
+
+		for(uint32_t v = 0; v < current.vertexCount; v++)
+			local[table.vertices[current.vertexOffset + v] - baseVertex] = -1;
+
+		computeBounds(current, table, positions);
+		table.meshlets.push_back(current);
+
+		current = {};
+		current.vertexOffset = static_cast<uint32_t>(table.vertices.size());
+		current.triangleOffset = static_cast<uint32_t>(table.triangles.size());
+	};
+
+	for(size_t k = 0; k + 2 < indexCount; k += 3)
+	{
+		const Index* corners = indices + k;
+		size_t newVertices = (local[corners[0]] < 0) +
+							 (local[corners[1]] < 0 && corners[1] != corners[0]) +
+							 (local[corners[2]] < 0 && corners[2] != corners[0] && corners[2] != corners[1]);
+
+		if(current.vertexCount + newVertices > vertexLimit || current.triangleCount + 1 > triangleLimit)
+			finish();
+
+		for(int c = 0; c < 3; c++)
+		{
+			if(local[corners[c]] < 0)
+			{
+				local[corners[c]] = static_cast<int>(current.vertexCount++);
+				table.vertices.push_back(static_cast<uint32_t>(baseVertex + corners[c]));
+			}
+			table.triangles.push_back(static_cast<uint8_t>(local[corners[c]]));
+		}
+		current.triangleCount++;
+	}
+
+	finish();
+}
+
+MeshletTable MeshletBuilder::buildTiles(const float* positions, const uint16_t* indices, const TerrainTile* tiles, size_t tileCount) const
+{
+	std::vector<MeshletTable> tables(tileCount);
+	parallelFor(tileCount, threadCount, [&](size_t first, size_t last)
+	{
+		for(size_t t = first; t < last; t++)
+			build(positions, indices + tiles[t].firstIndex, tiles[t].indexCount, tiles[t].baseVertex, tables[t]);
+	});
+
+	// Concatenate, shifting each tile's offsets past the tiles before it
+	MeshletTable result;
+	size_t meshletCount = 0, vertexCount = 0, triangleBytes = 0;
+	for(const MeshletTable& table : tables)
+	{
+		meshletCount += table.meshlets.size();
+		vertexCount += table.vertices.size();
+		triangleBytes += table.triangles.size();
+	}
+	result.meshlets.reserve(meshletCount);
+	result.vertices.reserve(vertexCount);
+	result.triangles.reserve(triangleBytes);
+
+	for(const MeshletTable& table : tables)
+	{
+		uint32_t vertexShift = static_cast<uint32_t>(result.vertices.size());
+		uint32_t triangleShift = static_cast<uint32_t>(result.triangles.size());
+		for(Meshlet meshlet : table.meshlets)
+		{
+			meshlet.vertexOffset += vertexShift;
+			meshlet.triangleOffset += triangleShift;
+			result.meshlets.push_back(meshlet);
+		}
+		result.vertices.insert(result.vertices.end(), table.vertices.begin(), table.vertices.end());
+		result.triangles.insert(result.triangles.end(), table.triangles.begin(), table.triangles.end());
+	}
+
+	return result;
+}
+
+bool validateMeshletCoverage(const MeshletTable& table, const MeshletBuilder& builder,
+							 const uint16_t* indices, const TerrainTile* tiles, size_t tileCount)
+{
+	std::vector<std::array<uint32_t, 3>> expected;
+	for(size_t t = 0; t < tileCount; t++)
+	{
+		const uint16_t* tileIndices = indices + tiles[t].firstIndex;
+		uint32_t base = static_cast<uint32_t>(tiles[t].baseVertex);
+		for(size_t k = 0; k + 2 < tiles[t].indexCount; k += 3)
+			expected.push_back(canonicalTriangle(base + tileIndices[k], base + tileIndices[k + 1], base + tileIndices[k + 2]));
+	}
+
+	std::vector<std::array<uint32_t, 3>> covered;
+	covered.reserve(expected.size());
+	for(const Meshlet& meshlet : table.meshlets)
+	{
+		if(meshlet.vertexCount > builder.maxVertices || meshlet.triangleCount > builder.maxTriangles)
+			return false;
+		if(meshlet.vertexOffset + meshlet.vertexCount > table.vertices.size() ||
+		   meshlet.triangleOffset + meshlet.triangleCount * 3 > table.triangles.size())
+			return false;
+
+		const uint32_t* vertices = table.vertices.data() + meshlet.vertexOffset;
+		const uint8_t* triangles = table.triangles.data() + meshlet.triangleOffset;
+		for(uint32_t t = 0; t < meshlet.triangleCount; t++)
+		{
+			if(triangles[t * 3] >= meshlet.vertexCount || triangles[t * 3 + 1] >= meshlet.vertexCount || triangles[t * 3 + 2] >= meshlet.vertexCount)
+				return false;
+			covered.push_back(canonicalTriangle(vertices[triangles[t * 3]], vertices[triangles[t * 3 + 1]], vertices[triangles[t * 3 + 2]]));
+		}
+	}
+
+	std::sort(expected.begin(), expected.end());
+	std::sort(covered.begin(), covered.end());
+	return expected == covered;
+}
+
+template void MeshletBuilder::build<unsigned int>(const float*, const unsigned int*, size_t, size_t, MeshletTable&) const;
+template void MeshletBuilder::build<uint16_t>(const float*, const uint16_t*, size_t, size_t, MeshletTable&) const;
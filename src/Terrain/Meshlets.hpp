@@ -0,0 +1,61 @@
+#pragma once
+#include "TerrainTiler.hpp"
+#include <cstdint>
+#include <vector>
+
+// A cluster of up to MeshletBuilder::maxVertices vertices and
+// maxTriangles triangles, with bounds for per-cluster culling
+struct Meshlet
+{
+	uint32_t vertexOffset;		// First entry in MeshletTable::vertices
+	uint32_t triangleOffset;	// First entry in MeshletTable::triangles
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+
+	// Bounding sphere
+	float center[3];
+	float radius;
+
+	// Every triangle normal lies within the cone around coneAxis whose
+	// half-angle has sine coneCutoff (1 when the cone can't cull anything)
+	float coneAxis[3];
+	float coneCutoff;
+
+	// True if every triangle faces away from a camera at cameraPosition
+	bool isBackfacing(const float cameraPosition[3]) const;
+};
+
+// Meshlets of a mesh, stored next to its vertex and index buffers
+struct MeshletTable
+{
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> vertices;	// Mesh vertex index of each meshlet vertex
+	std::vector<uint8_t> triangles;	// 3 meshlet-local vertex indices per triangle
+
+	size_t byteSize() const;
+};
+
+// Greedily packs consecutive triangles into meshlets, so the input order
+// (ideally vertex cache optimized) decides the clustering
+struct MeshletBuilder
+{
+	size_t maxVertices = 64;
+	size_t maxTriangles = 124;
+	unsigned threadCount = 1;
+
+	// Meshlets for one triangle list. Indices are relative to baseVertex,
+	// positions hold x, y, z of every mesh vertex.
+	template<typename Index>
+	void build(const float* positions, const Index* indices, size_t indexCount, size_t baseVertex, MeshletTable& table) const;
+
+	// Meshlets for all tiles of a tiled triangle list, built in parallel over tiles
+	MeshletTable buildTiles(const float* positions, const uint16_t* indices, const TerrainTile* tiles, size_t tileCount) const;
+};
+
+// Checks that the meshlets respect the limits and that together they contain
+// every triangle of the tiles exactly once, with the same winding
+bool validateMeshletCoverage(const MeshletTable& table, const MeshletBuilder& builder,
+							 const uint16_t* indices, const TerrainTile* tiles, size_t tileCount);
+
+extern template void MeshletBuilder::build<unsigned int>(const float*, const unsigned int*, size_t, size_t, MeshletTable&) const;
+extern template void MeshletBuilder::build<uint16_t>(const float*, const uint16_t*, size_t, size_t, MeshletTable&) const;
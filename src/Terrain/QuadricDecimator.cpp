@@ -0,0 +1,586 @@
+#include "QuadricDecimator.hpp"
+#include "../Util/Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace
+{
+	// Symmetric 4x4 quadric, stored as its upper triangle, of points relative
+	// to the vertex it belongs to. Nearby planes pass close to that origin,
+	// so floats keep the small costs that matter instead of losing them
+	// to the cancellation of large terms.
+	struct Quadric
+	{
+		float a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+		float b0 = 0, b1 = 0, b2 = 0;
+		float c = 0;
+
+		// Adds a plane through the origin
+		void addPlane(float nx, float ny, float nz)
+		{
+			a00 += nx * nx; a01 += nx * ny; a02 += nx * nz;
+			a11 += ny * ny; a12 += ny * nz; a22 += nz * nz;
+		}
+
+		// Adds q, this quadric's origin being at offset from q's
+		void add(const Quadric& q, const float* offset)
+		{
+			float x = offset[0], y = offset[1], z = offset[2];
+			a00 += q.a00; a01 += q.a01; a02 += q.a02;
+			a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0 + q.a00 * x + q.a01 * y + q.a02 * z;
+			b1 += q.b1 + q.a01 * x + q.a11 * y + q.a12 * z;
+			b2 += q.b2 + q.a02 * x + q.a12 * y + q.a22 * z;
+			c += q.error(offset);
+		}
+
+		// Sum of squared distances to the planes from offset, relative to the origin
+		float error(const float* offset) const
+		{
+			float x = offset[0], y = offset[1], z = offset[2];
+			float e = x * (a00 * x + 2.0f * (a01 * y + a02 * z + b0)) + y * (a11 * y + 2.0f * (a12 * z + b1)) +
+					  z * (a22 * z + 2.0f * b2) + c;
+			return std::max(e, 0.0f);
+		}
+	};
+
+	template<typename Real>
+	void cross(const float* a, const float* b, const float* c, Real* n)
+	{
+		Real e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		Real e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	// Every movable vertex has a heap entry for its cheapest collapse onto a
+	// neighbour. A collapse picks again for the neighbours whose cost it
+	// changed and queues them anew, their old entries are skipped once they
+	// come up. Vertices without a valid collapse are parked outside the
+	// heap until their ring changes.
+	struct DecimationState
+	{
+		static constexpr uint32_t None = ~0u;
+
+		// What a collapse reads of a vertex, in one cache line. A collapse of v
+		// onto w costs v's quadric error at w plus w's own, which is its
+		// quadric's constant term.
+		struct alignas(64) Vertex
+		{
+			Quadric quadric;
+			float position[3];		// Normalized to the bounds
+			uint32_t firstCorner;	// Of its corner list, see nextCorner
+			uint32_t bestTarget;	// Cheapest collapse and its cost
+			float bestCost;
+		};
+
+		enum Flags : uint8_t
+		{
+			Locked = 1,	// On a boundary, never moves
+			Parked = 2	// Out of the heap, nothing to collapse onto
+		};
+
+		bool heightField;
+		float maxCost;
+		std::vector<Vertex> vertices;
+		std::vector<uint8_t> flags;
+
+		// 3 per triangle. A collapsed triangle's first corner is None, and its
+		// corners are dropped from the lists whenever a walk comes across them.
+		std::vector<uint32_t> cornerVertices;
+		std::vector<float> normals;	// Unit normal each triangle started out with
+
+		// Each vertex's corners (3 * triangle + slot) are a singly linked list,
+		// a collapse hands its vertex's list over to the target
+		std::vector<uint32_t> nextCorner;
+
+		// Lazy-deletion heap of vertices by the top 10 bits of their cost, so
+		// 4 buckets per power of two. Pushes and pops are constant time, and an
+		// entry whose vertex's cost moved to another bucket is skipped. Each
+		// bucket comes out in vertex order, so collapses sweep through memory
+		// instead of jumping around the mesh.
+		static constexpr uint32_t costShift = 21;
+		std::vector<std::vector<uint32_t>> buckets;
+		uint32_t lowestBucket = 0;
+		std::vector<uint32_t> sortedSizes;	// Entries of each bucket already in order
+		size_t queued = 0;
+
+		std::vector<uint32_t> ring;	// Neighbours of a collapse's target
+
+		const float* position(uint32_t v) const
+		{
+			return vertices[v].position;
+		}
+
+		static uint32_t nextInTriangle(uint32_t corner)
+		{
+			return corner % 3 == 2 ? corner - 2 : corner + 1;
+		}
+
+		bool triangleHas(uint32_t corner, uint32_t v) const
+		{
+			const uint32_t* tri = cornerVertices.data() + (corner - corner % 3);
+			return tri[0] == v || tri[1] == v || tri[2] == v;
+		}
+
+		// Calls visit(corner) for v's live corners, unlinking collapsed ones
+		template<typename Visit>
+		void forEachCorner(uint32_t v, Visit visit)
+		{
+			uint32_t* link = &vertices[v].firstCorner;
+			while(*link != None)
+			{
+				uint32_t c = *link;
+				if(cornerVertices[c - c % 3] == None)
+				{
+					*link = nextCorner[c];
+					continue;
+				}
+				visit(c);
+				link = &nextCorner[c];
+			}
+		}
+
+		// An interior vertex's fan visits each of its neighbours once
+		template<typename Visit>
+		void forEachNeighbour(uint32_t v, Visit visit)
+		{
+			forEachCorner(v, [&](uint32_t c)
+			{
+				visit(cornerVertices[nextInTriangle(c)]);
+			});
+		}
+
+		void buildCorners()
+		{
+			nextCorner.resize(cornerVertices.size());
+			for(Vertex& vertex : vertices)
+				vertex.firstCorner = None;
+			for(size_t c = cornerVertices.size(); c > 0; c--)
+			{
+				Vertex& vertex = vertices[cornerVertices[c - 1]];
+				nextCorner[c - 1] = vertex.firstCorner;
+				vertex.firstCorner = static_cast<uint32_t>(c - 1);
+			}
+		}
+
+		uint32_t bucket(uint32_t v) const
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &vertices[v].bestCost, sizeof(bits));
+			return bits >> costShift;
+		}
+
+		void push(uint32_t v)
+		{
+			uint32_t b = bucket(v);
+			buckets[b].push_back(v);
+			lowestBucket = std::min(lowestBucket, b);
+			queued++;
+		}
+
+		// The bucket the next pop comes from, the heap mustn't be empty. What
+		// was pushed to it since it last came up gets sorted first.
+		uint32_t front()
+		{
+			while(buckets[lowestBucket].empty())
+				lowestBucket++;
+			std::vector<uint32_t>& entries = buckets[lowestBucket];
+			uint32_t& sorted = sortedSizes[lowestBucket];
+			if(entries.size() > sorted)
+			{
+				std::sort(entries.begin() + sorted, entries.end(), std::greater<uint32_t>());
+				sorted = static_cast<uint32_t>(entries.size());
+			}
+			return lowestBucket;
+		}
+
+		uint32_t pop()
+		{
+			std::vector<uint32_t>& entries = buckets[front()];
+			uint32_t v = entries.back();
+			entries.pop_back();
+			sortedSizes[lowestBucket] = std::min(sortedSizes[lowestBucket], static_cast<uint32_t>(entries.size()));
+			queued--;
+			return v;
+		}
+
+		float collapseCost(uint32_t from, uint32_t to) const
+		{
+			const float* p = position(from);
+			const float* q = position(to);
+			float offset[3] = { q[0] - p[0], q[1] - p[1], q[2] - p[2] };
+			return vertices[from].quadric.error(offset) + vertices[to].quadric.c;
+		}
+
+		void pickCollapse(uint32_t v)
+		{
+			// Locals, so the quadric stays in registers
+			const Quadric q = vertices[v].quadric;
+			const float p[3] = { vertices[v].position[0], vertices[v].position[1], vertices[v].position[2] };
+			float best = INFINITY;
+			uint32_t target = 0;
+			forEachNeighbour(v, [&](uint32_t w)
+			{
+				const Vertex& neighbour = vertices[w];
+				float offset[3] = { neighbour.position[0] - p[0], neighbour.position[1] - p[1], neighbour.position[2] - p[2] };
+				float cost = q.error(offset) + neighbour.quadric.c;
+				if(cost < best)
+				{
+					best = cost;
+					target = w;
+				}
+			});
+			vertices[v].bestCost = best;
+			vertices[v].bestTarget = target;
+		}
+
+		// Picks v's collapse again and queues it, or parks v if it's over maxCost
+		void requeue(uint32_t v)
+		{
+			pickCollapse(v);
+			if(vertices[v].bestCost <= maxCost)
+			{
+				flags[v] &= ~Parked;
+				push(v);
+			}
+			else
+			{
+				flags[v] |= Parked;
+			}
+		}
+
+		// Queues v again if its cost moved to another bucket. The entry it
+		// already has is skipped once it comes up.
+		void updated(uint32_t v, uint32_t oldBucket)
+		{
+			if(vertices[v].bestCost > maxCost)
+				flags[v] |= Parked;
+			else if(bucket(v) != oldBucket)
+				push(v);
+		}
+
+		// A collapse of from onto to changed w's ring. Parked vertices may have
+		// a valid collapse now. Collapses onto to cost more than before, so
+		// only neighbours whose cheapest went to from or to need picking
+		// again. The others only gained to as a neighbour.
+		void touch(uint32_t w, uint32_t from, uint32_t to)
+		{
+			if(flags[w] & Locked)
+				return;
+			if(flags[w] & Parked)
+			{
+				requeue(w);
+				return;
+			}
+
+			Vertex& vertex = vertices[w];
+			uint32_t oldBucket = bucket(w);
+			if(vertex.bestTarget == from || vertex.bestTarget == to)
+			{
+				pickCollapse(w);
+				updated(w, oldBucket);
+				return;
+			}
+			float cost = collapseCost(w, to);
+			if(cost < vertex.bestCost)
+			{
+				vertex.bestCost = cost;
+				vertex.bestTarget = to;
+				updated(w, oldBucket);
+			}
+		}
+
+		// Whether from can move onto to. Every remaining triangle of from has to
+		// keep facing about the same way, and the only vertices next to both
+		// ends may be the tips of the triangles on the edge (the link
+		// condition), or the mesh stops being manifold.
+		bool collapseIsValid(uint32_t from, uint32_t to)
+		{
+			ring.clear();
+			forEachCorner(to, [&](uint32_t corner)
+			{
+				const uint32_t* tri = cornerVertices.data() + (corner - corner % 3);
+				ring.push_back(tri[0] ^ tri[1] ^ tri[2] ^ to ^ cornerVertices[nextInTriangle(corner)]);
+				ring.push_back(cornerVertices[nextInTriangle(corner)]);
+			});
+
+			// from is interior, so its fan visits each neighbour once, tips included
+			uint32_t edgeTriangles = 0, shared = 0;
+			bool keeps = true;
+			forEachCorner(from, [&](uint32_t corner)
+			{
+				uint32_t first = corner - corner % 3;
+				const uint32_t* tri = cornerVertices.data() + first;
+				uint32_t w = cornerVertices[nextInTriangle(corner)];
+				shared += w != to && std::find(ring.begin(), ring.end(), w) != ring.end();
+				if(tri[0] == to || tri[1] == to || tri[2] == to)
+				{
+					edgeTriangles++;
+					return;
+				}
+				if(!keeps)
+					return;
+
+				const float* q[3];
+				for(uint32_t k = 0; k < 3; k++)
+					q[k] = position(first + k == corner ? to : tri[k]);
+
+				// Turning more than about 75 degrees away from the triangle's original
+				// normal counts as a flip. Small turns add up, and would otherwise
+				// stand triangles up on edge between locked vertices.
+				float after[3];
+				cross(q[0], q[1], q[2], after);
+				const float* reference = normals.data() + first;
+				float referenceDot = reference[0] * after[0] + reference[1] * after[1] + reference[2] * after[2];
+				float afterSquared = after[0] * after[0] + after[1] * after[1] + after[2] * after[2];
+				if(afterSquared == 0.0f || referenceDot <= 0.0f || referenceDot * referenceDot <= 0.0625f * afterSquared)
+					keeps = false;
+
+				// Height fields also have to keep their winding seen from above
+				else if(heightField && ((reference[1] > 0.0f) != (after[1] > 0.0f) || after[1] == 0.0f))
+					keeps = false;
+			});
+			return keeps && shared == edgeTriangles;
+		}
+
+		// The valid collapse of from onto a neighbour that costs least, up to
+		// maxCost, as its best target. False if there is none.
+		bool findValidTarget(uint32_t from)
+		{
+			Vertex& vertex = vertices[from];
+			if(collapseIsValid(from, vertex.bestTarget))
+				return true;
+
+			float bestValid = INFINITY;
+			uint32_t invalid = vertex.bestTarget, target = invalid;
+			forEachNeighbour(from, [&](uint32_t w)
+			{
+				if(w == invalid)
+					return;
+				float cost = collapseCost(from, w);
+				if(cost <= maxCost && cost < bestValid && collapseIsValid(from, w))
+				{
+					bestValid = cost;
+					target = w;
+				}
+			});
+			vertex.bestCost = bestValid;
+			vertex.bestTarget = target;
+			return bestValid != INFINITY;
+		}
+
+		// Moves from onto to and hands it from's corners, except those of the
+		// triangles on the edge, which go. Returns the number of triangles removed.
+		size_t collapse(uint32_t from, uint32_t to)
+		{
+			Vertex& source = vertices[from];
+			Vertex& target = vertices[to];
+			float offset[3] = { target.position[0] - source.position[0], target.position[1] - source.position[1], target.position[2] - source.position[2] };
+			target.quadric.add(source.quadric, offset);
+
+			size_t removed = 0;
+			uint32_t* link = &source.firstCorner;
+			while(*link != None)
+			{
+				uint32_t c = *link;
+				uint32_t first = c - c % 3;
+				if(cornerVertices[first] != None && triangleHas(c, to))
+				{
+					cornerVertices[first] = None;
+					removed++;
+				}
+				if(cornerVertices[first] == None)
+				{
+					*link = nextCorner[c];
+					continue;
+				}
+				cornerVertices[c] = to;
+				link = &nextCorner[c];
+			}
+			*link = target.firstCorner;
+			target.firstCorner = source.firstCorner;
+			source.firstCorner = None;
+			flags[from] = Locked;
+
+			// Every collapse of to costs something else now
+			if(flags[to] & Parked)
+				requeue(to);
+			else if(!(flags[to] & Locked))
+			{
+				uint32_t oldBucket = bucket(to);
+				pickCollapse(to);
+				updated(to, oldBucket);
+			}
+			forEachNeighbour(to, [&](uint32_t w)
+			{
+				touch(w, from, to);
+			});
+			return removed;
+		}
+	};
+}
+
+template<typename Index>
+size_t QuadricDecimator::decimate(const float* positions, size_t vertexCount, Index* indices, size_t indexCount, size_t targetTriangles) const
+{
+	using State = DecimationState;
+	size_t triangleCount = indexCount / 3;
+	if(triangleCount <= targetTriangles || vertexCount == 0)
+		return indexCount;
+
+	// Positions relative to the bounds, scaled so the largest side is 1
+	float lower[3], upper[3];
+	for(int k = 0; k < 3; k++)
+		lower[k] = upper[k] = positions[k];
+	for(size_t v = 0; v < vertexCount; v++)
+	for(int k = 0; k < 3; k++)
+	{
+		lower[k] = std::min(lower[k], positions[v * 3 + k]);
+		upper[k] = std::max(upper[k], positions[v * 3 + k]);
+	}
+	float extent = std::max({ upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2] });
+	float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+	State state;
+	state.heightField = heightField;
+	state.vertices.resize(vertexCount);
+	for(size_t v = 0; v < vertexCount; v++)
+	{
+		State::Vertex& vertex = state.vertices[v];
+		for(int k = 0; k < 3; k++)
+			vertex.position[k] = (positions[v * 3 + k] - lower[k]) * scale;
+		vertex.bestTarget = 0;
+		vertex.bestCost = INFINITY;
+	}
+	state.flags.assign(vertexCount, 0);
+
+	// Plane quadrics. Planes aren't weighted by area, so the square root of
+	// a cost bounds the distance to every merged plane.
+	state.cornerVertices.resize(triangleCount * 3);
+	state.normals.assign(triangleCount * 3, 0.0f);
+	for(size_t t = 0; t < triangleCount; t++)
+	{
+		uint32_t* tri = state.cornerVertices.data() + t * 3;
+		for(int k = 0; k < 3; k++)
+			tri[k] = static_cast<uint32_t>(indices[t * 3 + k]);
+
+		double n[3];
+		cross(state.position(tri[0]), state.position(tri[1]), state.position(tri[2]), n);
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if(length == 0.0)
+			continue;
+
+		float* normal = state.normals.data() + t * 3;
+		for(int k = 0; k < 3; k++)
+			normal[k] = static_cast<float>(n[k] / length);
+		// The plane goes through every corner, so it's at the origin of each
+		for(int k = 0; k < 3; k++)
+			state.vertices[tri[k]].quadric.addPlane(normal[0], normal[1], normal[2]);
+	}
+
+	// Costs are squared distances in normalized units
+	state.maxCost = std::isinf(maxError) ? INFINITY : (maxError * scale) * (maxError * scale);
+	state.buckets.resize((0x7fffffffu >> State::costShift) + 1);
+	state.sortedSizes.assign(state.buckets.size(), 0);
+	state.lowestBucket = static_cast<uint32_t>(state.buckets.size() - 1);
+
+	// Edges without a twin are on a boundary, and their ends are locked.
+	// Around a vertex, an edge out to w has its twin in the triangle where
+	// w comes before the vertex, and an edge in from w in the triangle
+	// where it comes after, so each vertex checks that its fan is closed.
+	state.buildCorners();
+	std::vector<uint32_t> after, before;
+	for(size_t v = 0; v < vertexCount; v++)
+	{
+		uint32_t vertex = static_cast<uint32_t>(v);
+		after.clear();
+		before.clear();
+		state.forEachCorner(vertex, [&](uint32_t c)
+		{
+			after.push_back(state.cornerVertices[State::nextInTriangle(c)]);
+			before.push_back(state.cornerVertices[State::nextInTriangle(State::nextInTriangle(c))]);
+		});
+		bool closed = !after.empty();
+		for(size_t k = 0; k < after.size() && closed; k++)
+			closed = std::find(before.begin(), before.end(), after[k]) != before.end() &&
+					 std::find(after.begin(), after.end(), before[k]) != after.end();
+		if(!closed)
+		{
+			state.flags[v] |= State::Locked;
+			continue;
+		}
+
+		state.pickCollapse(vertex);
+		if(state.vertices[v].bestCost <= state.maxCost)
+			state.push(vertex);
+		else
+			state.flags[v] |= State::Parked;
+	}
+
+	while(triangleCount > targetTriangles && state.queued > 0)
+	{
+		// Entries left behind by a vertex that was queued again, parked or collapsed
+		uint32_t queuedBucket = state.front();
+		uint32_t from = state.pop();
+		if((state.flags[from] & (State::Locked | State::Parked)) || queuedBucket != state.bucket(from))
+			continue;
+
+		uint32_t cheapest = state.vertices[from].bestTarget;
+		if(!state.findValidTarget(from))
+		{
+			state.flags[from] |= State::Parked;
+			continue;
+		}
+		if(state.vertices[from].bestTarget != cheapest && state.queued > 0 && state.bucket(from) > state.front())
+		{
+			state.push(from);
+			continue;
+		}
+
+		triangleCount -= state.collapse(from, state.vertices[from].bestTarget);
+	}
+
+	size_t written = 0;
+	for(size_t first = 0; first < state.cornerVertices.size(); first += 3)
+	{
+		if(state.cornerVertices[first] == State::None)
+			continue;
+		for(size_t k = 0; k < 3; k++)
+			indices[written++] = static_cast<Index>(state.cornerVertices[first + k]);
+	}
+	return written;
+}
+
+size_t QuadricDecimator::decimateTiles(const float* positions, uint16_t* indices, TerrainTile* tiles, size_t tileCount) const
+{
+	std::vector<size_t> indexCounts(tileCount);
+	parallelFor(tileCount, threadCount, [&](size_t first, size_t last)
+	{
+		for(size_t t = first; t < last; t++)
+		{
+			TerrainTile& tile = tiles[t];
+			size_t target = static_cast<size_t>(static_cast<double>(tile.indexCount / 3) * targetRatio);
+			indexCounts[t] = decimate(positions + tile.baseVertex * 3, tile.vertexCount(),
+									  indices + tile.firstIndex, tile.indexCount, target);
+		}
+	});
+
+	// Close the gaps the decimated tiles left behind
+	size_t offset = 0;
+	for(size_t t = 0; t < tileCount; t++)
+	{
+		std::memmove(indices + offset, indices + tiles[t].firstIndex, indexCounts[t] * sizeof(uint16_t));
+		tiles[t].firstIndex = offset;
+		tiles[t].indexCount = indexCounts[t];
+		offset += indexCounts[t];
+	}
+	return offset;
+}
+
+template size_t QuadricDecimator::decimate<unsigned int>(const float*, size_t, unsigned int*, size_t, size_t) const;
+template size_t QuadricDecimator::decimate<uint16_t>(const float*, size_t, uint16_t*, size_t, size_t) const;
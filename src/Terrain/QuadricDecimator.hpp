@@ -0,0 +1,37 @@
+#pragma once
+#include "TerrainTiler.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Quadric error metric edge-collapse simplification, after Garland and
+// Heckbert's "Surface Simplification Using Quadric Error Metrics".
+// Vertices are only ever collapsed onto a neighbour, so the result indexes
+// the original vertex buffer and terrain corners stay on the grid. Vertices
+// on open boundaries never move, which keeps tile seams matching, and
+// collapses that would flip a triangle are rejected.
+struct QuadricDecimator
+{
+	float targetRatio = 0.25f;	// Fraction of the triangles to keep
+	// Stops before collapses that could move the surface further than this
+	// from the planes of the original triangles around it, in position units
+	float maxError = std::numeric_limits<float>::infinity();
+	unsigned threadCount = 1;	// Tiles decimated in parallel
+
+	// Also keep every triangle's winding seen from above (along y), so
+	// terrain stays a height field without folds or vertical walls
+	bool heightField = true;
+
+	// Simplifies the triangle list in place down to targetTriangles, positions
+	// holding x, y, z of vertexCount vertices. Returns the new index count.
+	template<typename Index>
+	size_t decimate(const float* positions, size_t vertexCount, Index* indices, size_t indexCount, size_t targetTriangles) const;
+
+	// Decimates every tile of a tiled triangle list by targetRatio, then
+	// packs the index buffer and updates the tiles' index ranges.
+	// Returns the new total index count.
+	size_t decimateTiles(const float* positions, uint16_t* indices, TerrainTile* tiles, size_t tileCount) const;
+};
+
+extern template size_t QuadricDecimator::decimate<unsigned int>(const float*, size_t, unsigned int*, size_t, size_t) const;
+extern template size_t QuadricDecimator::decimate<uint16_t>(const float*, size_t, uint16_t*, size_t, size_t) const;
@@ -0,0 +1,106 @@
+#include "RawHeightfield.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+static const char rawMagic[4] = { 'I', 'T', 'T', 'H' };
+
+static const char* extensionOf(const char* path)
+{
+	const char* dot = std::strrchr(path, '.');
+	return dot == nullptr ? "" : dot;
+}
+
+bool isRawHeightfieldPath(const char* path)
+{
+	const char* extension = extensionOf(path);
+	return std::strcmp(extension, ".raw") == 0 || std::strcmp(extension, ".r16") == 0 || std::strcmp(extension, ".f32") == 0;
+}
+
+static bool parseFormat(const std::string& name, HeightFormat& format)
+{
+	if(name == "r8")
+		format = HeightFormat::UNorm8;
+	else if(name == "r16")
+		format = HeightFormat::UNorm16;
+	else if(name == "f32")
+		format = HeightFormat::Float32;
+	else
+		return false;
+	return true;
+}
+
+bool writeRawHeightfield(const char* path, const HeightfieldView& view)
+{
+	std::ofstream file(path, std::ios::binary);
+	if(!file)
+		return false;
+
+	RawHeightfieldHeader header;
+	std::memcpy(header.magic, rawMagic, sizeof(rawMagic));
+	header.width = static_cast<uint32_t>(view.width);
+	header.height = static_cast<uint32_t>(view.height);
+	header.format = static_cast<uint32_t>(view.format);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(view.samples), static_cast<std::streamsize>(view.byteSize()));
+	return static_cast<bool>(file);
+}
+
+// Fills view's size and format from the header, the sidecar or the
+// extension, and the offset of the samples in the file
+static bool describe(const char* path, const MappedFile& file, HeightfieldView& view, size_t& offset)
+{
+	RawHeightfieldHeader header;
+	if(file.size >= sizeof(header))
+	{
+		std::memcpy(&header, file.data, sizeof(header));
+		if(std::memcmp(header.magic, rawMagic, sizeof(rawMagic)) == 0)
+		{
+			if(header.format > static_cast<uint32_t>(HeightFormat::Float32))
+				return false;
+			view.width = static_cast<int>(header.width);
+			view.height = static_cast<int>(header.height);
+			view.format = static_cast<HeightFormat>(header.format);
+			offset = sizeof(header);
+			return true;
+		}
+	}
+
+	offset = 0;
+	std::ifstream sidecar(std::string(path) + ".meta");
+	if(sidecar)
+	{
+		std::string format;
+		return static_cast<bool>(sidecar >> view.width >> view.height >> format) && parseFormat(format, view.format);
+	}
+
+	const char* extension = extensionOf(path);
+	view.format = std::strcmp(extension, ".r16") == 0 ? HeightFormat::UNorm16 :
+				  std::strcmp(extension, ".f32") == 0 ? HeightFormat::Float32 : HeightFormat::UNorm8;
+	size_t samples = file.size / heightSampleSize(view.format);
+	size_t side = static_cast<size_t>(std::llround(std::sqrt(static_cast<double>(samples))));
+	view.width = view.height = static_cast<int>(side);
+	return side * side == samples;
+}
+
+bool MappedHeightfield::open(const char* path, MappedAccess access)
+{
+	view = HeightfieldView();
+	if(!file.open(path))
+		return false;
+
+	HeightfieldView described;
+	size_t offset;
+	if(!describe(path, file, described, offset) || described.width <= 0 || described.height <= 0 ||
+	   offset + described.byteSize() > file.size)
+	{
+		file.close();
+		return false;
+	}
+
+	described.samples = file.data + offset;
+	file.advise(access, offset, described.byteSize());
+	view = described;
+	return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Heightfield.hpp"
+#include "../Util/MappedFile.hpp"
+#include <cstdint>
+
+// Raw heightmaps are little-endian samples, row z of the file being texel row
+// z, as terrain pipelines export them. Their size and format come from the
+// first of:
+// - a RawHeightfieldHeader at the start of the file, the samples following it
+// - a sidecar next to the file, named like it plus ".meta", holding
+//   "<width> <height> <r8|r16|f32>"
+// - the extension, .raw for 8 bits, .r16 for 16 bits and .f32 for floats, of
+//   a square map with no header
+struct RawHeightfieldHeader
+{
+	char magic[4];		// "ITTH"
+	uint32_t width;
+	uint32_t height;
+	uint32_t format;	// A HeightFormat
+};
+
+// Whether path has one of the raw extensions
+bool isRawHeightfieldPath(const char* path);
+
+// Writes view with a header, false if the file can't be written
+bool writeRawHeightfield(const char* path, const HeightfieldView& view);
+
+// A raw heightmap mapped read-only, its view pointing straight into the
+// mapping, so opening it neither copies nor decodes anything and only the
+// pages that are read are loaded. Little-endian hosts only.
+struct MappedHeightfield
+{
+	MappedFile file;
+	HeightfieldView view;	// Empty if open() failed
+
+	// Maps path and hints how its samples will be read, false if it can't
+	// be mapped or its size doesn't match its description
+	bool open(const char* path, MappedAccess access = MappedAccess::Sequential);
+};
@@ -0,0 +1,552 @@
+#include "Roam.hpp"
+#include "HeightGrid.hpp"
+#include "LodSeams.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Roam::Queue::contains(int triangle) const
+{
+	return static_cast<size_t>(triangle) < positions.size() && positions[triangle] >= 0;
+}
+
+void Roam::Queue::place(size_t i, const Entry& entry)
+{
+	entries[i] = entry;
+	positions[entry.triangle] = static_cast<int>(i);
+}
+
+void Roam::Queue::siftUp(size_t i)
+{
+	Entry entry = entries[i];
+	while(i > 0)
+	{
+		size_t parent = (i - 1) / 2;
+		if(entries[parent].key >= entry.key)
+			break;
+		place(i, entries[parent]);
+		i = parent;
+	}
+	place(i, entry);
+}
+
+void Roam::Queue::siftDown(size_t i)
+{
+	Entry entry = entries[i];
+	size_t count = entries.size();
+	for(;;)
+	{
+		size_t child = 2 * i + 1;
+		if(child >= count)
+			break;
+		if(child + 1 < count && entries[child + 1].key > entries[child].key)
+			child++;
+		if(entries[child].key <= entry.key)
+			break;
+		place(i, entries[child]);
+		i = child;
+	}
+	place(i, entry);
+}
+
+void Roam::Queue::push(int triangle, float key, float due)
+{
+	if(positions.size() <= static_cast<size_t>(triangle))
+		positions.resize(static_cast<size_t>(triangle) + 1, -1);
+
+	entries.push_back({ key, triangle, due });
+	siftUp(entries.size() - 1);
+}
+
+void Roam::Queue::remove(int triangle)
+{
+	size_t i = static_cast<size_t>(positions[triangle]);
+	positions[triangle] = -1;
+
+	Entry last = entries.back();
+	entries.pop_back();
+	if(i < entries.size())
+	{
+		place(i, last);
+		siftUp(i);
+		siftDown(static_cast<size_t>(positions[last.triangle]));
+	}
+}
+
+void Roam::Queue::update(int triangle, float key, float due)
+{
+	rekey(triangle, key, due);
+	siftUp(static_cast<size_t>(positions[triangle]));
+	siftDown(static_cast<size_t>(positions[triangle]));
+}
+
+void Roam::Queue::rekey(int triangle, float key, float due)
+{
+	Entry& entry = entries[static_cast<size_t>(positions[triangle])];
+	entry.key = key;
+	entry.due = due;
+}
+
+void Roam::Queue::rebuild()
+{
+	for(size_t i = entries.size() / 2; i > 0; i--)
+		siftDown(i - 1);
+}
+
+Roam::Roam(const HeightGrid& grid)
+	: rtin(grid)
+{
+	if(rtin.size == 0)
+		return;
+
+	// The two halves of the grid on either side of the (0, 0)-(size, size)
+	// diagonal, as Rtin splits it
+	int s = rtin.size;
+	int stride = s + 1;
+	Triangle first = { s * stride, s * stride + s, 0, -1, -1, -1, -1, 1, 0.0f, 0, 0.0f, 0.0f, 0.0f };
+	Triangle second = { s, 0, s * stride + s, -1, -1, -1, -1, 0, 0.0f, 0, 0.0f, 0.0f, 0.0f };
+	triangles = { first, second };
+	triangleTotal = 2;
+
+	// Keyed by the first update, which computes every priority
+	for(int t = 0; t < 2; t++)
+	{
+		if(canSplit(triangles[t]))
+			splitQueue.push(t, 0.0f, 0.0f);
+	}
+}
+
+bool Roam::supports(int width, int height)
+{
+	return Rtin::supports(width, height);
+}
+
+bool Roam::canSplit(const Triangle& triangle) const
+{
+	// Triangles with unit legs have no corner in the middle of their hypotenuse
+	int stride = rtin.size + 1;
+	return std::abs(triangle.apex / stride - triangle.left / stride) + std::abs(triangle.apex % stride - triangle.left % stride) > 1;
+}
+
+float Roam::computePriority(const Triangle& triangle, float& distance, float& strength) const
+{
+	int stride = rtin.size + 1;
+	int lx = triangle.left / stride, ly = triangle.left % stride;
+	int rx = triangle.right / stride, ry = triangle.right % stride;
+	int mx = (lx + rx) / 2, my = (ly + ry) / 2;
+	size_t middle = static_cast<size_t>(mx) * static_cast<size_t>(stride) + static_cast<size_t>(my);
+
+	// Distance to the sphere around the hypotenuse, which holds the triangle
+	float dx = static_cast<float>(mx) - camera.position[0];
+	float dy = rtin.heights[middle] * camera.heightScale - camera.position[1];
+	float dz = static_cast<float>(my) - camera.position[2];
+	float radius = 0.5f * std::sqrt(static_cast<float>((lx - rx) * (lx - rx) + (ly - ry) * (ly - ry)));
+	distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz) - radius, 0.0f);
+
+	// Pixels at unit distance, as LodCamera::screenError() has them
+	strength = rtin.errors[middle] * unitPixels;
+	return distance > 0.0f ? strength / distance : std::numeric_limits<float>::infinity();
+}
+
+bool Roam::isMergeable(int t) const
+{
+	auto splitIntoLeaves = [&](int triangle)
+	{
+		int children = triangles[triangle].children;
+		return children >= 0 && triangles[children].children < 0 && triangles[children + 1].children < 0;
+	};
+
+	if(!splitIntoLeaves(t))
+		return false;
+
+	int base = triangles[t].baseNeighbor;
+	return base < 0 || (triangles[base].baseNeighbor == t && splitIntoLeaves(base));
+}
+
+int Roam::diamondOwner(int t) const
+{
+	int base = triangles[t].baseNeighbor;
+	return base >= 0 && triangles[base].baseNeighbor == t ? std::min(t, base) : t;
+}
+
+float Roam::priorityOf(int t)
+{
+	// Clamped to the parent's, so splitting never raises the priority and
+	// trading a diamond for a split can't come back to the same diamond
+	if(triangles[t].frame != frame)
+	{
+		// Each priority is a strength over a distance, which the camera
+		// moving by s changes by at most s. One of them that isn't the
+		// smallest only matters once it could drop below the smallest.
+		float tolerance = 1.0f + priorityTolerance;
+		auto floor = [&](float strength, float distance, float priority)
+		{
+			return tolerance * strength / priority - distance;
+		};
+
+		float distance, strength;
+		float priority = computePriority(triangles[t], distance, strength);
+		float reach = distance * priorityTolerance / tolerance;
+		float leastStrength = strength, mostDistance = distance;
+		int parent = triangles[t].parent;
+		if(parent >= 0)
+		{
+			float parentPriority = priorityOf(parent);
+			const Triangle& clamp = triangles[parent];
+			if(parentPriority < priority)
+			{
+				reach = std::min(clamp.reach, floor(strength, distance, parentPriority));
+				priority = parentPriority;
+			}
+			else
+			{
+				reach = std::min(reach, floor(clamp.leastStrength, clamp.mostDistance, priority));
+			}
+			leastStrength = std::min(leastStrength, clamp.leastStrength);
+			mostDistance = std::max(mostDistance, clamp.mostDistance);
+		}
+
+		// Zero stays zero wherever the camera goes
+		Triangle& triangle = triangles[t];
+		triangle.priority = priority;
+		triangle.reach = priority > 0.0f ? std::max(reach, 0.0f) : std::numeric_limits<float>::infinity();
+		triangle.leastStrength = leastStrength;
+		triangle.mostDistance = mostDistance;
+		triangle.frame = frame;
+	}
+	return triangles[t].priority;
+}
+
+float Roam::diamondPriority(int t)
+{
+	int base = triangles[t].baseNeighbor;
+	return base >= 0 ? std::max(priorityOf(t), priorityOf(base)) : priorityOf(t);
+}
+
+float Roam::dueTravel(int t, bool diamond) const
+{
+	const Triangle& triangle = triangles[t];
+	float reach = triangle.reach;
+	if(diamond && triangle.baseNeighbor >= 0)
+		reach = std::min(reach, triangles[triangle.baseNeighbor].reach);
+	return travel + reach;
+}
+
+void Roam::queueSplit(int t)
+{
+	float priority = priorityOf(t);
+	splitQueue.push(t, priority, dueTravel(t, false));
+}
+
+void Roam::unqueueSplit(int t)
+{
+	if(splitQueue.contains(t))
+		splitQueue.remove(t);
+}
+
+void Roam::queueDiamond(int t)
+{
+	if(!isMergeable(t))
+		return;
+
+	int owner = diamondOwner(t);
+	if(!mergeQueue.contains(owner))
+	{
+		float priority = diamondPriority(owner);
+		mergeQueue.push(owner, -priority, dueTravel(owner, true));
+	}
+}
+
+void Roam::unqueueDiamond(int t)
+{
+	int owner = diamondOwner(t);
+	if(mergeQueue.contains(owner))
+		mergeQueue.remove(owner);
+}
+
+void Roam::reprioritize(Queue& queue, bool all)
+{
+	// The entries whose priority the camera's travel may have moved past
+	// the tolerance
+	bool diamonds = &queue == &mergeQueue;
+	dueTriangles.clear();
+	for(const Queue::Entry& entry : queue.entries)
+	{
+		if(all || entry.due < travel)
+			dueTriangles.push_back(entry.triangle);
+	}
+
+	// Past about one entry in eight, heapifying beats sifting each
+	bool rebuilding = dueTriangles.size() * 8 > queue.entries.size();
+	for(int t : dueTriangles)
+	{
+		float key = diamonds ? -diamondPriority(t) : priorityOf(t);
+		float due = dueTravel(t, diamonds);
+		if(rebuilding)
+			queue.rekey(t, key, due);
+		else
+			queue.update(t, key, due);
+	}
+	if(rebuilding)
+		queue.rebuild();
+}
+
+int Roam::allocatePair()
+{
+	if(!freePairs.empty())
+	{
+		int pair = freePairs.back();
+		freePairs.pop_back();
+		return pair;
+	}
+
+	triangles.resize(triangles.size() + 2);
+	return static_cast<int>(triangles.size()) - 2;
+}
+
+void Roam::replaceNeighbor(int t, int from, int to)
+{
+	if(t < 0)
+		return;
+
+	Triangle& triangle = triangles[t];
+	if(triangle.baseNeighbor == from)
+		triangle.baseNeighbor = to;
+	else if(triangle.leftNeighbor == from)
+		triangle.leftNeighbor = to;
+	else if(triangle.rightNeighbor == from)
+		triangle.rightNeighbor = to;
+}
+
+void Roam::split(int t, RoamStats& stats)
+{
+	if(triangles[t].children >= 0)
+		return;
+
+	// A coarser base neighbour has to be split first, which makes one of
+	// its children this triangle's base neighbour
+	int base = triangles[t].baseNeighbor;
+	if(base >= 0 && triangles[base].baseNeighbor != t)
+		split(base, stats);
+
+	base = triangles[t].baseNeighbor;
+	splitOne(t, stats);
+	if(base >= 0)
+		splitOne(base, stats);
+
+	queueDiamond(t);
+}
+
+void Roam::splitOne(int t, RoamStats& stats)
+{
+	int children = allocatePair();
+	Triangle& triangle = triangles[t];
+
+	int stride = rtin.size + 1;
+	int middle = ((triangle.left / stride + triangle.right / stride) / 2) * stride +
+				 (triangle.left % stride + triangle.right % stride) / 2;
+
+	// The left child's hypotenuse is the left edge, the right child's the right edge
+	Triangle& left = triangles[children];
+	Triangle& right = triangles[children + 1];
+	left = { middle, triangle.apex, triangle.left, t, -1, children + 1, -1, triangle.leftNeighbor, 0.0f, 0, 0.0f, 0.0f, 0.0f };
+	right = { middle, triangle.right, triangle.apex, t, -1, -1, children, triangle.rightNeighbor, 0.0f, 0, 0.0f, 0.0f, 0.0f };
+
+	replaceNeighbor(triangle.leftNeighbor, t, children);
+	replaceNeighbor(triangle.rightNeighbor, t, children + 1);
+
+	// Across the hypotenuse, the halves of an already split base neighbour
+	int base = triangle.baseNeighbor;
+	if(base >= 0 && triangles[base].children >= 0)
+	{
+		int baseChildren = triangles[base].children;
+		triangles[baseChildren].rightNeighbor = children + 1;
+		triangles[baseChildren + 1].leftNeighbor = children;
+		left.rightNeighbor = baseChildren + 1;
+		right.leftNeighbor = baseChildren;
+	}
+	triangle.children = children;
+
+	unqueueSplit(t);
+	if(canSplit(left))
+	{
+		queueSplit(children);
+		queueSplit(children + 1);
+	}
+
+	// The parent's diamond now has a child that isn't a leaf
+	if(triangle.parent >= 0)
+		unqueueDiamond(triangle.parent);
+
+	triangleTotal++;
+	stats.splits++;
+}
+
+void Roam::merge(int t, RoamStats& stats)
+{
+	int base = triangles[t].baseNeighbor;
+	unqueueDiamond(t);
+
+	mergeOne(t);
+	if(base >= 0)
+		mergeOne(base);
+
+	// Which can make the parents' diamonds mergeable
+	if(triangles[t].parent >= 0)
+		queueDiamond(triangles[t].parent);
+	if(base >= 0 && triangles[base].parent >= 0)
+		queueDiamond(triangles[base].parent);
+
+	stats.merges++;
+}
+
+void Roam::mergeOne(int t)
+{
+	Triangle& triangle = triangles[t];
+	int children = triangle.children;
+
+	triangle.leftNeighbor = triangles[children].baseNeighbor;
+	triangle.rightNeighbor = triangles[children + 1].baseNeighbor;
+	replaceNeighbor(triangle.leftNeighbor, children, t);
+	replaceNeighbor(triangle.rightNeighbor, children + 1, t);
+
+	for(int c = children; c < children + 2; c++)
+		unqueueSplit(c);
+	triangles[children].children = -1;
+	triangles[children + 1].children = -1;
+	freePairs.push_back(children);
+
+	triangle.children = -1;
+	queueSplit(t);
+	triangleTotal--;
+}
+
+RoamStats Roam::update(const LodCamera& newCamera)
+{
+	RoamStats stats;
+	if(rtin.size == 0)
+		return stats;
+
+	// Anything but the position changes every priority by the same factor,
+	// which the travel can't bound
+	bool reproject = frame == 0 || newCamera.heightScale != camera.heightScale ||
+					 newCamera.verticalFov != camera.verticalFov || newCamera.viewportHeight != camera.viewportHeight;
+	float dx = newCamera.position[0] - camera.position[0];
+	float dy = newCamera.position[1] - camera.position[1];
+	float dz = newCamera.position[2] - camera.position[2];
+	camera = newCamera;
+	unitPixels = camera.screenError(1.0f, 1.0f);
+	frame++;
+
+	// The mesh and the queues' contents carry over from the last frame. Only
+	// the priorities that are due for the camera's travel get recomputed,
+	// unless they all changed.
+	auto queueStart = std::chrono::steady_clock::now();
+	if(reproject)
+		travel = 0.0f;
+	else
+		travel += std::sqrt(dx * dx + dy * dy + dz * dz);
+	reprioritize(splitQueue, reproject);
+	reprioritize(mergeQueue, reproject);
+	stats.queueMs = millisecondsSince(queueStart);
+
+	// Merge while over budget, split the worst triangle while it's over the
+	// error and fits, and trade diamonds that are better than it for room
+	auto refineStart = std::chrono::steady_clock::now();
+	size_t maxChanges = 4 * triangleBudget + 64;
+	for(size_t change = 0; change < maxChanges; change++)
+	{
+		if(triangleTotal > triangleBudget)
+		{
+			if(mergeQueue.entries.empty())
+				break;
+			merge(mergeQueue.entries[0].triangle, stats);
+			continue;
+		}
+
+		float maxSplit = splitQueue.entries.empty() ? 0.0f : splitQueue.entries[0].key;
+		float minMerge = mergeQueue.entries.empty() ? std::numeric_limits<float>::infinity() : -mergeQueue.entries[0].key;
+		if(maxSplit > maxPixelError)
+		{
+			if(triangleTotal + 2 <= triangleBudget)
+			{
+				// Forced splits can overshoot the budget. Making room with a
+				// diamond that matters as much as the split means the trade
+				// doesn't pay off, and repeating it would only go in circles.
+				split(splitQueue.entries[0].triangle, stats);
+				bool traded = true;
+				while(triangleTotal > triangleBudget && !mergeQueue.entries.empty())
+				{
+					traded = traded && -mergeQueue.entries[0].key < maxSplit;
+					merge(mergeQueue.entries[0].triangle, stats);
+				}
+				if(!traded)
+					break;
+			}
+			else if(minMerge < maxSplit)
+			{
+				merge(mergeQueue.entries[0].triangle, stats);
+			}
+			else
+			{
+				break;
+			}
+		}
+		else if(minMerge < maxPixelError)
+		{
+			// Finer than needed, the camera moved away
+			merge(mergeQueue.entries[0].triangle, stats);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	while(triangleTotal > triangleBudget && !mergeQueue.entries.empty())
+		merge(mergeQueue.entries[0].triangle, stats);
+	stats.refineMs = millisecondsSince(refineStart);
+
+	stats.triangles = triangleTotal;
+	stats.maxSplitError = splitQueue.entries.empty() ? 0.0f : splitQueue.entries[0].key;
+	return stats;
+}
+
+void Roam::writeIndices(std::vector<unsigned int>& indices) const
+{
+	indices.clear();
+	if(triangles.empty())
+		return;
+
+	// Rtin's corner index x * (size + 1) + y is the grid's vertex index
+	indices.reserve(triangleTotal * 3);
+	std::vector<int> stack = { 1, 0 };
+	while(!stack.empty())
+	{
+		const Triangle& triangle = triangles[stack.back()];
+		stack.pop_back();
+
+		if(triangle.children >= 0)
+		{
+			stack.push_back(triangle.children + 1);
+			stack.push_back(triangle.children);
+			continue;
+		}
+
+		indices.push_back(static_cast<unsigned int>(triangle.apex));
+		indices.push_back(static_cast<unsigned int>(triangle.left));
+		indices.push_back(static_cast<unsigned int>(triangle.right));
+	}
+}
+
+bool validateRoamIndices(const std::vector<unsigned int>& indices, int size)
+{
+	return validateGridWatertight(indices, size, size);
+}
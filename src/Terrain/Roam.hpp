@@ -0,0 +1,129 @@
+#pragma once
+#include "ChunkedLod.hpp"
+#include "Rtin.hpp"
+#include <cstddef>
+#include <vector>
+
+// What one Roam::update() did
+struct RoamStats
+{
+	size_t splits = 0;			// Including the splits forced on neighbours
+	size_t merges = 0;
+	size_t triangles = 0;		// After the update
+	float maxSplitError = 0.0f;	// Largest pixel error of a triangle left unsplit
+	double queueMs = 0.0;		// Reprioritizing what the camera's motion could have changed
+	double refineMs = 0.0;		// Splits and merges, with their queue updates
+};
+
+// Real-time optimally adapting mesh after Duchaineau et al.'s "ROAMing
+// Terrain". The triangulation is a bintree over a square power-of-two
+// heightmap, kept from frame to frame. Leaves wait in a split queue and
+// diamonds of split triangles in a merge queue, both ordered by pixel error
+// for the current camera. Priorities are only recomputed once the camera
+// has travelled far enough to change them by more than priorityTolerance,
+// after the paper's deferred priority updates. Each update then splits the
+// worst leaves and merges the best diamonds until the mesh is within the
+// budget and the error, so only what the camera's motion changed is
+// touched. Forced splits keep the mesh free of T-junctions.
+// Triangle errors come from Rtin, which uses the same bintree.
+struct Roam
+{
+	size_t triangleBudget = 65536;	// Never exceeded after update()
+	float maxPixelError = 1.0f;		// Leaves are split until within it, budget allowing
+	float priorityTolerance = 0.1f;	// Fraction queued priorities may be off by
+
+	explicit Roam(const HeightGrid& grid);
+
+	// Square power-of-two heightmaps only
+	static bool supports(int width, int height);
+
+	RoamStats update(const LodCamera& camera);
+
+	size_t triangleCount() const
+	{
+		return triangleTotal;
+	}
+
+	// Replaces indices with the current leaves as a triangle list of grid
+	// vertex indices i * (size + 1) + j, wound like the full grid
+	void writeIndices(std::vector<unsigned int>& indices) const;
+
+private:
+	// A triangle with its right angle at apex and hypotenuse left-right.
+	// Its left edge is apex-left, its right edge apex-right.
+	struct Triangle
+	{
+		int apex, left, right;	// Corners in Rtin order, x * (size + 1) + y
+		int parent;
+		int children;			// Left child, the right child follows it, -1 for leaves
+		int leftNeighbor, rightNeighbor, baseNeighbor;
+		float priority;			// Pixel error for the camera of frame
+		unsigned frame;			// Update the priority was computed in, 0 for none
+		float reach;			// Camera travel the priority stays within the tolerance for
+		float leastStrength;	// Pixels at unit distance of the priorities it's clamped to
+		float mostDistance;		// Distance of the farthest of them
+	};
+
+	// Binary max-heap of triangles that knows where each triangle is,
+	// so triangles can leave it when they're split or merged
+	struct Queue
+	{
+		struct Entry
+		{
+			float key;
+			int triangle;
+			float due;	// Camera travel the key has to be recomputed at
+		};
+
+		std::vector<Entry> entries;
+		std::vector<int> positions;	// Per triangle, -1 when not queued
+
+		bool contains(int triangle) const;
+		void push(int triangle, float key, float due);
+		void remove(int triangle);
+		void update(int triangle, float key, float due);
+		void rekey(int triangle, float key, float due);	// Leaves the order to rebuild()
+		void rebuild();
+		void siftUp(size_t i);
+		void siftDown(size_t i);
+		void place(size_t i, const Entry& entry);
+	};
+
+	Rtin rtin;
+	std::vector<Triangle> triangles;
+	std::vector<int> freePairs;
+	size_t triangleTotal = 0;
+	Queue splitQueue;	// Leaves that can be split, by priority
+	Queue mergeQueue;	// Mergeable diamonds by their lower id, by negated priority
+	LodCamera camera;
+	float unitPixels = 0.0f;	// Pixels a unit error covers at unit distance
+	unsigned frame = 0;
+	float travel = 0.0f;	// Camera path length since the priorities were last all computed
+	std::vector<int> dueTriangles;
+
+	float computePriority(const Triangle& triangle, float& distance, float& strength) const;
+	bool canSplit(const Triangle& triangle) const;
+	bool isMergeable(int t) const;
+	int diamondOwner(int t) const;
+	float priorityOf(int t);
+	float diamondPriority(int t);
+	float dueTravel(int t, bool diamond) const;
+	void queueSplit(int t);
+	void unqueueSplit(int t);
+	void queueDiamond(int t);
+	void unqueueDiamond(int t);
+	void reprioritize(Queue& queue, bool all);
+
+	int allocatePair();
+	void replaceNeighbor(int t, int from, int to);
+	void split(int t, RoamStats& stats);
+	void splitOne(int t, RoamStats& stats);
+	void merge(int t, RoamStats& stats);
+	void mergeOne(int t);
+};
+
+// Checks that indices, as written by Roam::writeIndices(), tile the size x size
+// grid exactly: every triangle is wound like the grid, their areas add up to the
+// grid's and every edge inside the grid is shared by exactly two triangles, so
+// there are no T-junctions
+bool validateRoamIndices(const std::vector<unsigned int>& indices, int size);
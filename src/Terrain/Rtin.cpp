@@ -0,0 +1,111 @@
+#include "Rtin.hpp"
+#include "HeightGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// Triangles are (a, b, c) with hypotenuse a-b and the right angle at c.
+// Splitting adds the hypotenuse midpoint m and gives the children
+// (c, a, m) and (b, c, m). Triangles with unit legs can't be split.
+
+Rtin::Rtin(const HeightGrid& grid)
+{
+	if(!supports(grid.width, grid.height))
+	{
+		std::cout << "RTIN needs a square power-of-two heightmap, got " << grid.width << "x" << grid.height << std::endl;
+		return;
+	}
+
+	size = grid.width;
+	heights = grid.cornerHeights();
+	errors.assign(heights.size(), 0.0f);
+	vertexIds.assign(heights.size(), 0);
+
+	// A split's error includes its children's, so the levels are processed
+	// bottom-up. Children are shared with the neighbour across each leg,
+	// hence the whole level has to be finished before the next one.
+	int levels = 0;
+	for(int s = size; s > 1; s >>= 1)
+		levels += 2;
+
+	for(int level = levels - 1; level >= 0; level--)
+	{
+		computeErrors(0, 0, size, size, size, 0, 0, level);
+		computeErrors(size, size, 0, 0, 0, size, 0, level);
+	}
+}
+
+bool Rtin::supports(int width, int height)
+{
+	return width == height && width > 0 && (width & (width - 1)) == 0;
+}
+
+void Rtin::computeErrors(int ax, int ay, int bx, int by, int cx, int cy, int depth, int targetDepth)
+{
+	int mx = (ax + bx) >> 1;
+	int my = (ay + by) >> 1;
+
+	if(depth < targetDepth)
+	{
+		computeErrors(cx, cy, ax, ay, mx, my, depth + 1, targetDepth);
+		computeErrors(bx, by, cx, cy, mx, my, depth + 1, targetDepth);
+		return;
+	}
+
+	float interpolated = 0.5f * (heights[cornerIndex(ax, ay)] + heights[cornerIndex(bx, by)]);
+	size_t middle = cornerIndex(mx, my);
+	float error = std::fabs(interpolated - heights[middle]);
+
+	// Children that can be split themselves
+	if(std::abs(cx - mx) + std::abs(cy - my) > 1)
+	{
+		error = std::max(error, errors[cornerIndex((cx + ax) >> 1, (cy + ay) >> 1)]);
+		error = std::max(error, errors[cornerIndex((bx + cx) >> 1, (by + cy) >> 1)]);
+	}
+
+	errors[middle] = std::max(errors[middle], error);
+}
+
+unsigned int Rtin::vertex(int x, int y, GridTriangulation& out)
+{
+	unsigned int& id = vertexIds[cornerIndex(x, y)];
+	if(id == 0)
+	{
+		out.corners.push_back(static_cast<unsigned int>(cornerIndex(x, y)));
+		id = static_cast<unsigned int>(out.corners.size());
+	}
+	return id - 1;
+}
+
+void Rtin::split(int ax, int ay, int bx, int by, int cx, int cy, float maxError, GridTriangulation& out)
+{
+	int mx = (ax + bx) >> 1;
+	int my = (ay + by) >> 1;
+
+	if(std::abs(ax - cx) + std::abs(ay - cy) > 1 && errors[cornerIndex(mx, my)] > maxError)
+	{
+		split(cx, cy, ax, ay, mx, my, maxError, out);
+		split(bx, by, cx, cy, mx, my, maxError, out);
+		return;
+	}
+
+	// (a, c, b) winds like the grid's triangles
+	out.indices.push_back(vertex(ax, ay, out));
+	out.indices.push_back(vertex(cx, cy, out));
+	out.indices.push_back(vertex(bx, by, out));
+}
+
+GridTriangulation Rtin::extract(float maxError)
+{
+	GridTriangulation result;
+	if(size == 0)
+		return result;
+
+	split(0, 0, size, size, size, 0, maxError, result);
+	split(size, size, 0, 0, 0, size, maxError, result);
+
+	for(unsigned int corner : result.corners)
+		vertexIds[corner] = 0;
+	return result;
+}
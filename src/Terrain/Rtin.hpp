@@ -0,0 +1,42 @@
+#pragma once
+#include "GridTriangulation.hpp"
+#include <vector>
+
+struct HeightGrid;
+
+// Right-triangulated irregular network over the corners of a square
+// 2^k x 2^k heightmap. The constructor computes, once, the error of every
+// corner that can be added by splitting a triangle along its hypotenuse,
+// including the errors of all splits below it. extract() then walks the
+// split tree down only as far as maxError requires, so meshes for any
+// error can be cut in milliseconds, and they never have T-junctions.
+struct Rtin
+{
+	int size = 0;				// Cells per side, 0 if the heightmap isn't supported
+	std::vector<float> heights;	// Corner heights in TerrainMeshBuilder vertex order
+	std::vector<float> errors;	// Per corner, in the same units as the heights
+
+	explicit Rtin(const HeightGrid& grid);
+
+	// Square power-of-two heightmaps only
+	static bool supports(int width, int height);
+
+	// Coarsest triangulation where every left out corner's split error is at
+	// most maxError. Errors are measured against the split hypotenuse, so on
+	// rough terrain the distance to the final surface can exceed maxError a bit.
+	// 0 keeps every corner that doesn't lie on a straight line.
+	// Reuses internal scratch memory, so it can't be called concurrently.
+	GridTriangulation extract(float maxError);
+
+private:
+	std::vector<unsigned int> vertexIds;	// Per corner, output vertex + 1 or 0
+
+	size_t cornerIndex(int x, int y) const
+	{
+		return static_cast<size_t>(x) * static_cast<size_t>(size + 1) + static_cast<size_t>(y);
+	}
+
+	void computeErrors(int ax, int ay, int bx, int by, int cx, int cy, int depth, int targetDepth);
+	void split(int ax, int ay, int bx, int by, int cx, int cy, float maxError, GridTriangulation& out);
+	unsigned int vertex(int x, int y, GridTriangulation& out);
+};
@@ -0,0 +1,322 @@
+#include "TerrainKernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ITT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// Scalar vertices for j in [firstJ, lastJ)
+	void writeVertexSpan(int i, int firstJ, int lastJ, int width, int height, float* positions, float* texCoords)
+	{
+		float x = static_cast<float>(i);
+		float u = x / static_cast<float>(width);
+
+		for(int j = firstJ; j < lastJ; j++)
+		{
+			float z = static_cast<float>(j);
+
+			*positions++ = x;
+			*positions++ = 0.0f;
+			*positions++ = z;
+
+			*texCoords++ = u;
+			*texCoords++ = z / static_cast<float>(height);
+		}
+	}
+
+	void writeVertexRowScalar(int i, int firstJ, int count, int width, int height, float* positions, float* texCoords)
+	{
+		writeVertexSpan(i, firstJ, firstJ + count, width, height, positions, texCoords);
+	}
+
+	void writeIndexRowScalar(unsigned int rowBase, unsigned int stride, int cells, unsigned int* indices)
+	{
+		for(int j = 0; j < cells; j++)
+		{
+			unsigned int a = rowBase + static_cast<unsigned int>(j);
+			unsigned int b = a + stride;
+
+			*indices++ = a;
+			*indices++ = b;
+			*indices++ = b + 1;
+			*indices++ = b + 1;
+			*indices++ = a + 1;
+			*indices++ = a;
+		}
+	}
+
+#ifdef ITT_X86_KERNELS
+	// Per-lane constants for kernels processing Lanes vertices per step.
+	// A step writes 3 registers of xyz and 2 registers of uv. Every value is
+	// built from products with 0 or 1 and small integer sums, so it is exact
+	// and matches the scalar kernels bit for bit.
+	template<int Lanes>
+	struct LaneConstants
+	{
+		float posX[3 * Lanes];		// 1 in x lanes
+		float posZ[3 * Lanes];		// 1 in z lanes
+		float posOffset[3 * Lanes];	// Vertex offset within the step in z lanes
+		float uvU[2 * Lanes];		// 1 in u lanes
+		float uvV[2 * Lanes];		// 1 in v lanes
+		float uvOffset[2 * Lanes];	// Vertex offset within the step in v lanes
+
+		LaneConstants()
+		{
+			for(int f = 0; f < 3 * Lanes; f++)
+			{
+				int component = f % 3;
+				posX[f] = component == 0 ? 1.0f : 0.0f;
+				posZ[f] = component == 2 ? 1.0f : 0.0f;
+				posOffset[f] = component == 2 ? static_cast<float>(f / 3) : 0.0f;
+			}
+
+			for(int f = 0; f < 2 * Lanes; f++)
+			{
+				int component = f % 2;
+				uvU[f] = component == 0 ? 1.0f : 0.0f;
+				uvV[f] = component == 1 ? 1.0f : 0.0f;
+				uvOffset[f] = component == 1 ? static_cast<float>(f / 2) : 0.0f;
+			}
+		}
+	};
+
+	const LaneConstants<4> constants4;
+	const LaneConstants<8> constants8;
+	const LaneConstants<16> constants16;
+
+	// A step of the index kernels writes 3 registers holding the 6 indices
+	// of Lanes / 2 cells, as offsets from the first cell's corner a
+	template<int Lanes>
+	void indexOffsets(unsigned int stride, unsigned int* offsets)
+	{
+		const unsigned int corner[6] = { 0, stride, stride + 1, stride + 1, 1, 0 };
+		for(int f = 0; f < 3 * Lanes; f++)
+			offsets[f] = static_cast<unsigned int>(f / 6) + corner[f % 6];
+	}
+
+	__attribute__((target("sse2")))
+	void writeVertexRowSSE2(int i, int firstJ, int count, int width, int height, float* positions, float* texCoords)
+	{
+		const int lanes = 4;
+		const LaneConstants<lanes>& c = constants4;
+
+		float x = static_cast<float>(i);
+		__m128 vx = _mm_set1_ps(x);
+		__m128 vu = _mm_set1_ps(x / static_cast<float>(width));
+		__m128 vh = _mm_set1_ps(static_cast<float>(height));
+
+		int lastJ = firstJ + count;
+		int j = firstJ;
+		for(; j + lanes <= lastJ; j += lanes)
+		{
+			__m128 vj = _mm_set1_ps(static_cast<float>(j));
+			for(int r = 0; r < 3; r++)
+			{
+				__m128 z = _mm_add_ps(_mm_mul_ps(vj, _mm_loadu_ps(c.posZ + r * lanes)), _mm_loadu_ps(c.posOffset + r * lanes));
+				_mm_storeu_ps(positions + r * lanes, _mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(c.posX + r * lanes)), z));
+			}
+			for(int r = 0; r < 2; r++)
+			{
+				__m128 z = _mm_add_ps(_mm_mul_ps(vj, _mm_loadu_ps(c.uvV + r * lanes)), _mm_loadu_ps(c.uvOffset + r * lanes));
+				_mm_storeu_ps(texCoords + r * lanes, _mm_add_ps(_mm_mul_ps(vu, _mm_loadu_ps(c.uvU + r * lanes)), _mm_div_ps(z, vh)));
+			}
+			positions += 3 * lanes;
+			texCoords += 2 * lanes;
+		}
+
+		writeVertexSpan(i, j, lastJ, width, height, positions, texCoords);
+	}
+
+	__attribute__((target("sse2")))
+	void writeIndexRowSSE2(unsigned int rowBase, unsigned int stride, int cells, unsigned int* indices)
+	{
+		const int lanes = 4;
+		unsigned int offsets[3 * lanes];
+		indexOffsets<lanes>(stride, offsets);
+
+		__m128i o[3];
+		for(int r = 0; r < 3; r++)
+			o[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets + r * lanes));
+
+		int j = 0;
+		for(; j + lanes / 2 <= cells; j += lanes / 2)
+		{
+			__m128i a = _mm_set1_epi32(static_cast<int>(rowBase + static_cast<unsigned int>(j)));
+			for(int r = 0; r < 3; r++)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + r * lanes), _mm_add_epi32(a, o[r]));
+			indices += 3 * lanes;
+		}
+
+		writeIndexRowScalar(rowBase + static_cast<unsigned int>(j), stride, cells - j, indices);
+	}
+
+	__attribute__((target("avx2")))
+	void writeVertexRowAVX2(int i, int firstJ, int count, int width, int height, float* positions, float* texCoords)
+	{
+		const int lanes = 8;
+		const LaneConstants<lanes>& c = constants8;
+
+		float x = static_cast<float>(i);
+		__m256 vx = _mm256_set1_ps(x);
+		__m256 vu = _mm256_set1_ps(x / static_cast<float>(width));
+		__m256 vh = _mm256_set1_ps(static_cast<float>(height));
+
+		int lastJ = firstJ + count;
+		int j = firstJ;
+		for(; j + lanes <= lastJ; j += lanes)
+		{
+			__m256 vj = _mm256_set1_ps(static_cast<float>(j));
+			for(int r = 0; r < 3; r++)
+			{
+				__m256 z = _mm256_add_ps(_mm256_mul_ps(vj, _mm256_loadu_ps(c.posZ + r * lanes)), _mm256_loadu_ps(c.posOffset + r * lanes));
+				_mm256_storeu_ps(positions + r * lanes, _mm256_add_ps(_mm256_mul_ps(vx, _mm256_loadu_ps(c.posX + r * lanes)), z));
+			}
+			for(int r = 0; r < 2; r++)
+			{
+				__m256 z = _mm256_add_ps(_mm256_mul_ps(vj, _mm256_loadu_ps(c.uvV + r * lanes)), _mm256_loadu_ps(c.uvOffset + r * lanes));
+				_mm256_storeu_ps(texCoords + r * lanes, _mm256_add_ps(_mm256_mul_ps(vu, _mm256_loadu_ps(c.uvU + r * lanes)), _mm256_div_ps(z, vh)));
+			}
+			positions += 3 * lanes;
+			texCoords += 2 * lanes;
+		}
+
+		writeVertexSpan(i, j, lastJ, width, height, positions, texCoords);
+	}
+
+	__attribute__((target("avx2")))
+	void writeIndexRowAVX2(unsigned int rowBase, unsigned int stride, int cells, unsigned int* indices)
+	{
+		const int lanes = 8;
+		unsigned int offsets[3 * lanes];
+		indexOffsets<lanes>(stride, offsets);
+
+		__m256i o[3];
+		for(int r = 0; r < 3; r++)
+			o[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + r * lanes));
+
+		int j = 0;
+		for(; j + lanes / 2 <= cells; j += lanes / 2)
+		{
+			__m256i a = _mm256_set1_epi32(static_cast<int>(rowBase + static_cast<unsigned int>(j)));
+			for(int r = 0; r < 3; r++)
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(indices + r * lanes), _mm256_add_epi32(a, o[r]));
+			indices += 3 * lanes;
+		}
+
+		writeIndexRowScalar(rowBase + static_cast<unsigned int>(j), stride, cells - j, indices);
+	}
+
+	__attribute__((target("avx512f")))
+	void writeVertexRowAVX512(int i, int firstJ, int count, int width, int height, float* positions, float* texCoords)
+	{
+		const int lanes = 16;
+		const LaneConstants<lanes>& c = constants16;
+
+		float x = static_cast<float>(i);
+		__m512 vx = _mm512_set1_ps(x);
+		__m512 vu = _mm512_set1_ps(x / static_cast<float>(width));
+		__m512 vh = _mm512_set1_ps(static_cast<float>(height));
+
+		int lastJ = firstJ + count;
+		int j = firstJ;
+		for(; j + lanes <= lastJ; j += lanes)
+		{
+			__m512 vj = _mm512_set1_ps(static_cast<float>(j));
+			for(int r = 0; r < 3; r++)
+			{
+				__m512 z = _mm512_add_ps(_mm512_mul_ps(vj, _mm512_loadu_ps(c.posZ + r * lanes)), _mm512_loadu_ps(c.posOffset + r * lanes));
+				_mm512_storeu_ps(positions + r * lanes, _mm512_add_ps(_mm512_mul_ps(vx, _mm512_loadu_ps(c.posX + r * lanes)), z));
+			}
+			for(int r = 0; r < 2; r++)
+			{
+				__m512 z = _mm512_add_ps(_mm512_mul_ps(vj, _mm512_loadu_ps(c.uvV + r * lanes)), _mm512_loadu_ps(c.uvOffset + r * lanes));
+				_mm512_storeu_ps(texCoords + r * lanes, _mm512_add_ps(_mm512_mul_ps(vu, _mm512_loadu_ps(c.uvU + r * lanes)), _mm512_div_ps(z, vh)));
+			}
+			positions += 3 * lanes;
+			texCoords += 2 * lanes;
+		}
+
+		writeVertexSpan(i, j, lastJ, width, height, positions, texCoords);
+	}
+
+	__attribute__((target("avx512f")))
+	void writeIndexRowAVX512(unsigned int rowBase, unsigned int stride, int cells, unsigned int* indices)
+	{
+		const int lanes = 16;
+		unsigned int offsets[3 * lanes];
+		indexOffsets<lanes>(stride, offsets);
+
+		__m512i o[3];
+		for(int r = 0; r < 3; r++)
+			o[r] = _mm512_loadu_si512(offsets + r * lanes);
+
+		int j = 0;
+		for(; j + lanes / 2 <= cells; j += lanes / 2)
+		{
+			__m512i a = _mm512_set1_epi32(static_cast<int>(rowBase + static_cast<unsigned int>(j)));
+			for(int r = 0; r < 3; r++)
+				_mm512_storeu_si512(indices + r * lanes, _mm512_add_epi32(a, o[r]));
+			indices += 3 * lanes;
+		}
+
+		writeIndexRowScalar(rowBase + static_cast<unsigned int>(j), stride, cells - j, indices);
+	}
+#endif
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+	switch(level)
+	{
+	case SimdLevel::SSE2: return "SSE2";
+	case SimdLevel::AVX2: return "AVX2";
+	case SimdLevel::AVX512: return "AVX-512";
+	default: return "scalar";
+	}
+}
+
+bool isSimdLevelSupported(SimdLevel level)
+{
+#ifdef ITT_X86_KERNELS
+	switch(level)
+	{
+	case SimdLevel::SSE2: return __builtin_cpu_supports("sse2");
+	case SimdLevel::AVX2: return __builtin_cpu_supports("avx2");
+	case SimdLevel::AVX512: return __builtin_cpu_supports("avx512f");
+	default: return true;
+	}
+#else
+	return level == SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel detectSimdLevel()
+{
+	static const SimdLevel detected = []()
+	{
+		const SimdLevel levels[] = { SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE2 };
+		for(SimdLevel level : levels)
+			if(isSimdLevelSupported(level))
+				return level;
+		return SimdLevel::Scalar;
+	}();
+	return detected;
+}
+
+TerrainRowKernels getRowKernels(SimdLevel level)
+{
+	if(!isSimdLevelSupported(level))
+		level = SimdLevel::Scalar;
+
+	switch(level)
+	{
+#ifdef ITT_X86_KERNELS
+	case SimdLevel::SSE2: return { writeVertexRowSSE2, writeIndexRowSSE2 };
+	case SimdLevel::AVX2: return { writeVertexRowAVX2, writeIndexRowAVX2 };
+	case SimdLevel::AVX512: return { writeVertexRowAVX512, writeIndexRowAVX512 };
+#endif
+	default: return { writeVertexRowScalar, writeIndexRowScalar };
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// Instruction set tiers for the row kernels, narrowest first
+enum class SimdLevel
+{
+	Scalar,
+	SSE2,
+	AVX2,
+	AVX512
+};
+
+const char* simdLevelName(SimdLevel level);
+
+// Widest level supported by both this build and the running CPU
+SimdLevel detectSimdLevel();
+bool isSimdLevelSupported(SimdLevel level);
+
+// Kernels that generate one grid row (one value of i) at a time.
+// Every level produces bit-identical output to the scalar one.
+struct TerrainRowKernels
+{
+	// Writes count vertices of row i starting at column firstJ, for a
+	// width x height grid
+	void (*writeVertexRow)(int i, int firstJ, int count, int width, int height, float* positions, float* texCoords);
+
+	// Writes 6 indices for each of the cells quads starting at vertex rowBase,
+	// with stride vertices between rows
+	void (*writeIndexRow)(unsigned int rowBase, unsigned int stride, int cells, unsigned int* indices);
+};
+
+// Falls back to the scalar kernels for unsupported levels
+TerrainRowKernels getRowKernels(SimdLevel level);
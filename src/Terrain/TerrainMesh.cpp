@@ -0,0 +1,211 @@
+#include "TerrainMesh.hpp"
+#include "Arena.hpp"
+#include "HeightGrid.hpp"
+#include "../Util/Parallel.hpp"
+#include <iostream>
+
+size_t TerrainMeshView::vertexCount() const
+{
+	return positions.size / 3;
+}
+
+size_t TerrainMeshView::byteSize() const
+{
+	return positions.bytes() + texCoords.bytes() + indices.bytes();
+}
+
+size_t TerrainMesh::vertexCount() const
+{
+	return positions.size() / 3;
+}
+
+size_t TerrainMesh::byteSize() const
+{
+	return positions.size() * sizeof(float) +
+		   texCoords.size() * sizeof(float) +
+		   indices.size() * sizeof(unsigned int);
+}
+
+TerrainMeshView TerrainMesh::view()
+{
+	TerrainMeshView view;
+	view.positions = { positions.data(), positions.size() };
+	view.texCoords = { texCoords.data(), texCoords.size() };
+	view.indices = { indices.data(), indices.size() };
+	return view;
+}
+
+TerrainMeshBuilder::TerrainMeshBuilder(int width, int height)
+	: width(width), height(height), simdLevel(detectSimdLevel())
+{
+}
+
+size_t TerrainMeshBuilder::vertexCount() const
+{
+	return static_cast<size_t>(width + 1) * static_cast<size_t>(height + 1);
+}
+
+size_t TerrainMeshBuilder::indexCount() const
+{
+	return gridIndexCount(width, height, primitive);
+}
+
+bool TerrainMeshBuilder::fitsUInt32Indices() const
+{
+	// The largest value is reserved for primitive restart
+	return vertexCount() - 1 < 0xFFFFFFFFull;
+}
+
+GridVertex TerrainMeshBuilder::gridVertex(int i, int j, bool withHeight) const
+{
+	float x = static_cast<float>(i);
+	float z = static_cast<float>(j);
+
+	GridVertex v;
+	v.x = x;
+	v.y = 0.0f;
+	v.z = z;
+	v.u = x / static_cast<float>(width);
+	v.v = z / static_cast<float>(height);
+	v.height = withHeight && heights != nullptr ? heights->cornerHeight(i, j) : 0.0f;
+	return v;
+}
+
+void TerrainMeshBuilder::writeVertices(float* positions, float* texCoords) const
+{
+	parallelFor(static_cast<size_t>(width + 1), threadCount, [&](size_t first, size_t last)
+	{
+		writeVertexRows(static_cast<int>(first), static_cast<int>(last), positions, texCoords);
+	});
+}
+
+void TerrainMeshBuilder::writeIndices(unsigned int* indices) const
+{
+	if(primitive == PrimitiveMode::TriangleStrip)
+	{
+		parallelFor(static_cast<size_t>(height), threadCount, [&](size_t first, size_t last)
+		{
+			writeGridStrips(width, height, static_cast<int>(first), static_cast<int>(last), indices);
+		});
+		return;
+	}
+
+	parallelFor(static_cast<size_t>(width), threadCount, [&](size_t first, size_t last)
+	{
+		writeIndexRows(static_cast<int>(first), static_cast<int>(last), indices);
+	});
+}
+
+void TerrainMeshBuilder::writeVertexRows(int firstRow, int lastRow, float* positions, float* texCoords) const
+{
+	TerrainRowKernels kernels = getRowKernels(simdLevel);
+
+	size_t rowLength = static_cast<size_t>(height + 1);
+	for(int i = firstRow; i < lastRow; i++)
+	{
+		size_t rowStart = static_cast<size_t>(i) * rowLength;
+		kernels.writeVertexRow(i, 0, height + 1, width, height, positions + rowStart * 3, texCoords + rowStart * 2);
+	}
+}
+
+void TerrainMeshBuilder::writeIndexRows(int firstRow, int lastRow, unsigned int* indices) const
+{
+	TerrainRowKernels kernels = getRowKernels(simdLevel);
+
+	// Same winding as the legacy quads: (i, j), (i+1, j), (i+1, j+1), (i, j+1)
+	unsigned int stride = static_cast<unsigned int>(height + 1);
+	for(int i = firstRow; i < lastRow; i++)
+	{
+		size_t rowStart = static_cast<size_t>(i) * static_cast<size_t>(height) * 6;
+		kernels.writeIndexRow(static_cast<unsigned int>(i) * stride, stride, height, indices + rowStart);
+	}
+}
+
+TerrainMesh TerrainMeshBuilder::build() const
+{
+	TerrainMesh mesh;
+	if(!fitsUInt32Indices())
+	{
+		std::cout << "Terrain is too large for 32-bit indices, use TerrainTiler instead" << std::endl;
+		return mesh;
+	}
+
+	mesh.positions.resize(vertexCount() * 3);
+	mesh.texCoords.resize(vertexCount() * 2);
+	mesh.indices.resize(indexCount());
+
+	writeVertices(mesh.positions.data(), mesh.texCoords.data());
+	writeIndices(mesh.indices.data());
+	return mesh;
+}
+
+size_t TerrainMeshBuilder::arenaBytes() const
+{
+	return Arena::alignedSize(vertexCount() * 3 * sizeof(float)) +
+		   Arena::alignedSize(vertexCount() * 2 * sizeof(float)) +
+		   Arena::alignedSize(indexCount() * sizeof(unsigned int));
+}
+
+TerrainMeshView TerrainMeshBuilder::build(Arena& arena) const
+{
+	TerrainMeshView mesh;
+	if(!fitsUInt32Indices())
+	{
+		std::cout << "Terrain is too large for 32-bit indices, use TerrainTiler instead" << std::endl;
+		return mesh;
+	}
+
+	mesh.positions = arena.allocate<float>(vertexCount() * 3);
+	mesh.texCoords = arena.allocate<float>(vertexCount() * 2);
+	mesh.indices = arena.allocate<unsigned int>(indexCount());
+
+	writeVertices(mesh.positions.data, mesh.texCoords.data);
+	writeIndices(mesh.indices.data);
+	return mesh;
+}
+
+TerrainMesh buildLegacyTerrainMesh(int width, int height)
+{
+	size_t area = static_cast<size_t>(width) * static_cast<size_t>(height);
+
+	TerrainMesh mesh;
+	mesh.positions.reserve(area * 12);
+	mesh.indices.reserve(area * 6);
+	mesh.texCoords.reserve(area * 8);
+
+	unsigned int index = 0;
+	for(float i = 0; i < width; i++)
+	for(float j = 0; j < height; j++)
+	{
+		std::vector<float> currentVPos
+		{
+			i, 0.0f, j,
+			i + 1.0f, 0.0f, j,
+			i + 1.0f, 0.0f, j + 1.0f,
+			i, 0.0f, j + 1.0f,
+		};
+
+		mesh.positions.insert(mesh.positions.end(), currentVPos.begin(), currentVPos.end());
+
+		std::vector<unsigned int> currentIndices
+		{
+			index, index + 1, index + 2,
+			index + 2, index + 3, index
+		};
+
+		mesh.indices.insert(mesh.indices.end(), currentIndices.begin(), currentIndices.end());
+		index += 4;
+
+		std::vector<float> currentTexCoordinates
+		{
+			i / width, j / height,
+			(i+1) / width, j / height,
+			(i+1) / width, (j+1) / height,
+			i / width, (j+1) / height
+		};
+
+		mesh.texCoords.insert(mesh.texCoords.end(), currentTexCoordinates.begin(), currentTexCoordinates.end());
+	}
+
+	return mesh;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "Span.hpp"
+#include "TerrainKernels.hpp"
+#include "GridIndices.hpp"
+#include <vector>
+#include <cstddef>
+
+struct Arena;
+struct HeightGrid;
+
+// A terrain grid corner before it is encoded into a vertex format
+struct GridVertex
+{
+	float x, y, z;	// y is added to the height, in heightmap units, to lower skirt vertices
+	float u, v;
+	float height;	// Sampled heightmap value, 0 unless requested from a HeightGrid
+};
+
+// Non-owning terrain geometry, usually pointing into an Arena
+struct TerrainMeshView
+{
+	Span<float> positions;
+	Span<float> texCoords;
+	Span<unsigned int> indices;
+
+	size_t vertexCount() const;
+	size_t byteSize() const;
+};
+
+// CPU-side terrain geometry, ready to be uploaded into buffers
+struct TerrainMesh
+{
+	std::vector<float> positions;		// x, y, z per vertex
+	std::vector<float> texCoords;		// u, v per vertex
+	std::vector<unsigned int> indices;	// Triangle list
+
+	size_t vertexCount() const;
+	size_t byteSize() const;
+
+	TerrainMeshView view();
+};
+
+// Builds a (width + 1) x (height + 1) grid of shared vertices for a
+// width x height heightmap, with two triangles per texel.
+// Vertex (i, j) sits at index i * (height + 1) + j.
+// With threadCount > 1 the rows are split into bands that are written in
+// parallel at precomputed offsets; the output is identical to a serial build.
+// Rows are generated by the kernels for simdLevel, which defaults to the
+// widest instruction set the CPU supports. Indices are a triangle list or
+// triangle strips depending on primitive.
+struct TerrainMeshBuilder
+{
+	int width;
+	int height;
+	unsigned threadCount = 1;
+	SimdLevel simdLevel;
+	PrimitiveMode primitive = PrimitiveMode::Triangles;
+	const HeightGrid* heights = nullptr;	// Only needed by formats with baked heights
+
+	TerrainMeshBuilder(int width, int height);
+
+	size_t vertexCount() const;
+	size_t indexCount() const;
+
+	// Whether every vertex can be addressed by an unsigned int index.
+	// Larger grids have to be split up with TerrainTiler.
+	bool fitsUInt32Indices() const;
+
+	// Corner (i, j), with position and texcoords computed exactly like the
+	// row kernels do. The height is only sampled when withHeight is set.
+	GridVertex gridVertex(int i, int j, bool withHeight) const;
+
+	// Write into caller-provided arrays of vertexCount() * 3,
+	// vertexCount() * 2 and indexCount() elements
+	void writeVertices(float* positions, float* texCoords) const;
+	void writeIndices(unsigned int* indices) const;
+
+	// Serial kernels for rows [firstRow, lastRow), writing at the rows' offsets.
+	// writeIndexRows() always writes a triangle list.
+	void writeVertexRows(int firstRow, int lastRow, float* positions, float* texCoords) const;
+	void writeIndexRows(int firstRow, int lastRow, unsigned int* indices) const;
+
+	// Bytes an Arena needs to hold the output of build(Arena&)
+	size_t arenaBytes() const;
+
+	TerrainMesh build() const;
+
+	// Allocation-free build into arena memory, valid until the arena is reset.
+	// Both builds return an empty mesh if the grid doesn't fit 32-bit indices.
+	TerrainMeshView build(Arena& arena) const;
+};
+
+// The original generator with 4 unique vertices per texel, kept for A/B comparisons
+TerrainMesh buildLegacyTerrainMesh(int width, int height);
@@ -0,0 +1,114 @@
+#include "TerrainTiler.hpp"
+#include <algorithm>
+
+size_t TerrainTile::vertexCount() const
+{
+	return static_cast<size_t>(rows + 1) * static_cast<size_t>(columns + 1);
+}
+
+TerrainTiler::TerrainTiler(int width, int height)
+	: grid(width, height)
+{
+}
+
+int TerrainTiler::cellsPerTile() const
+{
+	int limit = grid.primitive == PrimitiveMode::TriangleStrip ? maxStripTileCells : maxTileCells;
+	return std::min(tileCells, limit);
+}
+
+int TerrainTiler::tilesAlongRows() const
+{
+	return (grid.width + cellsPerTile() - 1) / cellsPerTile();
+}
+
+int TerrainTiler::tilesAlongColumns() const
+{
+	return (grid.height + cellsPerTile() - 1) / cellsPerTile();
+}
+
+size_t TerrainTiler::tileCount() const
+{
+	return static_cast<size_t>(tilesAlongRows()) * static_cast<size_t>(tilesAlongColumns());
+}
+
+TerrainTile TerrainTiler::tile(size_t index) const
+{
+	// Tiles are ordered like grid vertices, i-major. Only the last tile of
+	// each tile row and the tiles of the last tile row can be smaller.
+	int cells = cellsPerTile();
+	int tilesPerRow = tilesAlongColumns();
+	int tileRow = static_cast<int>(index / static_cast<size_t>(tilesPerRow));
+	int tileColumn = static_cast<int>(index % static_cast<size_t>(tilesPerRow));
+	int lastColumns = grid.height - (tilesPerRow - 1) * cells;
+
+	TerrainTile tile;
+	tile.firstRow = tileRow * cells;
+	tile.firstColumn = tileColumn * cells;
+	tile.rows = std::min(cells, grid.width - tile.firstRow);
+	tile.columns = std::min(cells, grid.height - tile.firstColumn);
+
+	// Neighbouring tiles duplicate the corners of their shared edge
+	size_t fullRowVertices = static_cast<size_t>(cells + 1) * static_cast<size_t>(grid.height + tilesPerRow);
+	size_t fullRowIndices = (tilesPerRow - 1) * gridIndexCount(cells, cells, grid.primitive) +
+							gridIndexCount(cells, lastColumns, grid.primitive);
+
+	tile.baseVertex = static_cast<size_t>(tileRow) * fullRowVertices +
+					  static_cast<size_t>(tile.rows + 1) * static_cast<size_t>(tileColumn * (cells + 1));
+	tile.firstIndex = static_cast<size_t>(tileRow) * fullRowIndices +
+					  static_cast<size_t>(tileColumn) * gridIndexCount(tile.rows, cells, grid.primitive);
+	tile.indexCount = gridIndexCount(tile.rows, tile.columns, grid.primitive);
+	return tile;
+}
+
+size_t TerrainTiler::vertexCount() const
+{
+	return static_cast<size_t>(grid.width + tilesAlongRows()) * static_cast<size_t>(grid.height + tilesAlongColumns());
+}
+
+size_t TerrainTiler::indexCount() const
+{
+	if(tileCount() == 0)
+		return 0;
+
+	TerrainTile last = tile(tileCount() - 1);
+	return last.firstIndex + last.indexCount;
+}
+
+void TerrainTiler::writeTileVertices(const TerrainTile& tile, float* positions, float* texCoords) const
+{
+	TerrainRowKernels kernels = getRowKernels(grid.simdLevel);
+
+	size_t vertex = tile.baseVertex;
+	for(int a = 0; a <= tile.rows; a++)
+	{
+		kernels.writeVertexRow(tile.firstRow + a, tile.firstColumn, tile.columns + 1, grid.width, grid.height,
+							   positions + vertex * 3, texCoords + vertex * 2);
+		vertex += static_cast<size_t>(tile.columns + 1);
+	}
+}
+
+void TerrainTiler::writeTileIndices(const TerrainTile& tile, uint16_t* indices) const
+{
+	if(grid.primitive == PrimitiveMode::TriangleStrip)
+	{
+		writeGridStrips(tile.rows, tile.columns, 0, tile.columns, indices);
+		return;
+	}
+
+	// Same corner order and winding as TerrainMeshBuilder
+	uint16_t stride = static_cast<uint16_t>(tile.columns + 1);
+	for(int a = 0; a < tile.rows; a++)
+	for(int b = 0; b < tile.columns; b++)
+	{
+		uint16_t c = static_cast<uint16_t>(a * stride + b);
+		uint16_t d = static_cast<uint16_t>(c + stride);
+
+		*indices++ = c;
+		*indices++ = d;
+		*indices++ = static_cast<uint16_t>(d + 1);
+		*indices++ = static_cast<uint16_t>(d + 1);
+		*indices++ = static_cast<uint16_t>(c + 1);
+		*indices++ = c;
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "VertexLayout.hpp"
+#include "VertexCacheOptimizer.hpp"
+#include <cstdint>
+
+// A rectangle of grid cells meshed on its own, with vertices local enough
+// to be addressed by 16-bit indices. Row a / column b of the tile's corners
+// is vertex baseVertex + a * (columns + 1) + b.
+struct TerrainTile
+{
+	int firstRow;		// Grid i of the tile's first corner
+	int firstColumn;	// Grid j of the tile's first corner
+	int rows;			// Cells along i
+	int columns;		// Cells along j
+	size_t baseVertex;
+	size_t firstIndex;
+	size_t indexCount;
+
+	size_t vertexCount() const;
+};
+
+// Splits a TerrainMeshBuilder grid into tiles of at most tileCells x tileCells
+// cells. Each tile gets unsigned short indices relative to its baseVertex,
+// which halves index memory and lifts the 32-bit limit on grid size.
+// Indices follow grid.primitive.
+struct TerrainTiler
+{
+	// 256 x 256 corners is the most a 16-bit index can address, one
+	// fewer per side when 0xFFFF is taken by primitive restart
+	static constexpr int maxTileCells = 255;
+	static constexpr int maxStripTileCells = 254;
+
+	TerrainMeshBuilder grid;
+	int tileCells = maxTileCells;
+
+	// Reorder each tile's triangle list for a post-transform cache of this
+	// many entries, 0 keeps the generated row order. Ignored for strips.
+	int vertexCacheSize = 0;
+
+	TerrainTiler(int width, int height);
+
+	// tileCells, limited to what the primitive mode can index
+	int cellsPerTile() const;
+
+	int tilesAlongRows() const;
+	int tilesAlongColumns() const;
+	size_t tileCount() const;
+	TerrainTile tile(size_t index) const;
+
+	size_t vertexCount() const;
+	size_t indexCount() const;
+
+	// Kernels for a single tile, writing at the tile's own offsets
+	void writeTileVertices(const TerrainTile& tile, float* positions, float* texCoords) const;
+	void writeTileIndices(const TerrainTile& tile, uint16_t* indices) const;
+};
+
+// Tiled terrain geometry encoded with Layout, pointing into an Arena
+template<typename Layout>
+struct TiledMeshView
+{
+	Span<unsigned char> buffers[Layout::bufferCount];
+	Span<uint16_t> indices;
+	Span<TerrainTile> tiles;
+	Span<uint16_t> morphTargets;	// Half float per vertex, empty unless the builder makes them
+	size_t vertexCount = 0;
+	PrimitiveMode primitive = PrimitiveMode::Triangles;
+
+	size_t byteSize() const
+	{
+		size_t total = indices.bytes() + morphTargets.bytes();
+		for(const Span<unsigned char>& buffer : buffers)
+			total += buffer.bytes();
+		return total;
+	}
+};
+
+template<typename Layout>
+size_t tiledArenaBytes(const TerrainTiler& tiler)
+{
+	size_t total = Arena::alignedSize(tiler.indexCount() * sizeof(uint16_t)) +
+				   Arena::alignedSize(tiler.tileCount() * sizeof(TerrainTile));
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		total += Arena::alignedSize(tiler.vertexCount() * Layout::bufferStride(b));
+	return total;
+}
+
+// Builds every tile in the given vertex format, in parallel over tiles
+template<typename Layout>
+TiledMeshView<Layout> buildTiledMesh(const TerrainTiler& tiler, Arena& arena)
+{
+	TiledMeshView<Layout> mesh;
+	if(!layoutFitsGrid<Layout>(tiler.grid.width, tiler.grid.height))
+		return mesh;
+
+	mesh.vertexCount = tiler.vertexCount();
+	mesh.primitive = tiler.grid.primitive;
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		mesh.buffers[b] = arena.allocate<unsigned char>(mesh.vertexCount * Layout::bufferStride(b));
+	mesh.indices = arena.allocate<uint16_t>(tiler.indexCount());
+	mesh.tiles = arena.allocate<TerrainTile>(tiler.tileCount());
+
+	for(size_t t = 0; t < mesh.tiles.size; t++)
+		mesh.tiles[t] = tiler.tile(t);
+
+	const bool withHeight = Layout::template has<AttributeRole::Height>;
+	parallelFor(mesh.tiles.size, tiler.grid.threadCount, [&](size_t first, size_t last)
+	{
+		for(size_t t = first; t < last; t++)
+		{
+			const TerrainTile& tile = mesh.tiles[t];
+			tiler.writeTileIndices(tile, mesh.indices.data + tile.firstIndex);
+			if(tiler.vertexCacheSize > 0 && mesh.primitive == PrimitiveMode::Triangles)
+				optimizeVertexCache(mesh.indices.data + tile.firstIndex, tile.indexCount, tile.vertexCount(), tiler.vertexCacheSize);
+
+			if constexpr(std::is_same_v<Layout, SoALayout>)
+			{
+				tiler.writeTileVertices(tile, reinterpret_cast<float*>(mesh.buffers[0].data),
+										reinterpret_cast<float*>(mesh.buffers[1].data));
+			}
+			else
+			{
+				unsigned char* buffers[Layout::bufferCount];
+				for(size_t b = 0; b < Layout::bufferCount; b++)
+					buffers[b] = mesh.buffers[b].data;
+
+				size_t index = tile.baseVertex;
+				for(int a = 0; a <= tile.rows; a++)
+				for(int b = 0; b <= tile.columns; b++)
+					Layout::write(buffers, index++, tiler.grid.gridVertex(tile.firstRow + a, tile.firstColumn + b, withHeight));
+			}
+		}
+	});
+
+	return mesh;
+}
@@ -0,0 +1,345 @@
+#include "TiledHeightfield.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+static const char tiledMagic[4] = { 'I', 'T', 'T', 'T' };
+
+// Samples are little-endian unsigned integers of Size bytes, floats are
+// delta coded by their bits. Size is a template argument so the copies
+// compile to plain loads and stores.
+template<size_t Size>
+static uint32_t loadSample(const unsigned char* samples, size_t i)
+{
+	uint32_t value = 0;
+	std::memcpy(&value, samples + i * Size, Size);
+	return value;
+}
+
+template<size_t Size>
+static void storeSample(unsigned char* samples, size_t i, uint32_t value)
+{
+	std::memcpy(samples + i * Size, &value, Size);
+}
+
+// The sample before i, or the one above it at the start of a row
+static size_t predictor(size_t i, int tileSize)
+{
+	return i % static_cast<size_t>(tileSize) == 0 ? i - static_cast<size_t>(tileSize) : i - 1;
+}
+
+template<size_t Size>
+static void encodeDeltas(const unsigned char* samples, int tileSize, std::vector<unsigned char>& out)
+{
+	out.clear();
+	const int shift = 32 - 8 * static_cast<int>(Size);
+	size_t count = static_cast<size_t>(tileSize) * static_cast<size_t>(tileSize);
+	for(size_t i = 0; i < count; i++)
+	{
+		uint32_t value = loadSample<Size>(samples, i);
+		uint32_t previous = i == 0 ? 0 : loadSample<Size>(samples, predictor(i, tileSize));
+
+		// Wrapped to the sample's width, then sign extended and zigzagged
+		int32_t delta = static_cast<int32_t>((value - previous) << shift) >> shift;
+		uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+		while(zigzag >= 0x80)
+		{
+			out.push_back(static_cast<unsigned char>(zigzag | 0x80));
+			zigzag >>= 7;
+		}
+		out.push_back(static_cast<unsigned char>(zigzag));
+	}
+}
+
+template<size_t Size>
+static bool decodeDeltas(const unsigned char* in, size_t inSize, int tileSize, unsigned char* samples)
+{
+	const uint32_t mask = Size == 4 ? 0xffffffffu : (1u << (8 * Size)) - 1;
+	const unsigned char* end = in + inSize;
+	size_t count = static_cast<size_t>(tileSize) * static_cast<size_t>(tileSize);
+	for(size_t i = 0; i < count; i++)
+	{
+		uint32_t zigzag = 0;
+		for(int bits = 0;; bits += 7)
+		{
+			if(in == end || bits > 28)
+				return false;
+			unsigned char byte = *in++;
+			zigzag |= static_cast<uint32_t>(byte & 0x7f) << bits;
+			if((byte & 0x80) == 0)
+				break;
+		}
+
+		uint32_t delta = (zigzag >> 1) ^ (0u - (zigzag & 1));
+		uint32_t previous = i == 0 ? 0 : loadSample<Size>(samples, predictor(i, tileSize));
+		storeSample<Size>(samples, i, (previous + delta) & mask);
+	}
+	return in == end;
+}
+
+static void encodeDeltas(const unsigned char* samples, int tileSize, size_t sampleSize, std::vector<unsigned char>& out)
+{
+	if(sampleSize == 1)
+		encodeDeltas<1>(samples, tileSize, out);
+	else if(sampleSize == 2)
+		encodeDeltas<2>(samples, tileSize, out);
+	else
+		encodeDeltas<4>(samples, tileSize, out);
+}
+
+static bool decodeDeltas(const std::vector<unsigned char>& in, int tileSize, size_t sampleSize, unsigned char* samples)
+{
+	if(sampleSize == 1)
+		return decodeDeltas<1>(in.data(), in.size(), tileSize, samples);
+	if(sampleSize == 2)
+		return decodeDeltas<2>(in.data(), in.size(), tileSize, samples);
+	return decodeDeltas<4>(in.data(), in.size(), tileSize, samples);
+}
+
+bool writeTiledHeightfield(const char* path, const HeightfieldView& source, int tileSize, bool compress)
+{
+	if(source.empty() || tileSize <= 0)
+		return false;
+
+	std::ofstream file(path, std::ios::binary);
+	if(!file)
+		return false;
+
+	TiledHeightfieldHeader header;
+	std::memcpy(header.magic, tiledMagic, sizeof(tiledMagic));
+	header.version = tiledHeightfieldVersion;
+	header.width = static_cast<uint32_t>(source.width);
+	header.height = static_cast<uint32_t>(source.height);
+	header.tileSize = static_cast<uint32_t>(tileSize);
+	header.format = static_cast<uint32_t>(source.format);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// The index is written once the tiles' offsets are known
+	int tilesAlongX = (source.width + tileSize - 1) / tileSize;
+	int tilesAlongZ = (source.height + tileSize - 1) / tileSize;
+	std::vector<TiledHeightfieldEntry> index(static_cast<size_t>(tilesAlongX) * static_cast<size_t>(tilesAlongZ));
+	file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(TiledHeightfieldEntry)));
+
+	size_t sampleSize = heightSampleSize(source.format);
+	size_t tileBytes = static_cast<size_t>(tileSize) * static_cast<size_t>(tileSize) * sampleSize;
+	std::vector<unsigned char> samples(tileBytes), encoded;
+	for(int tz = 0; tz < tilesAlongZ; tz++)
+	for(int tx = 0; tx < tilesAlongX; tx++)
+	{
+		for(int r = 0; r < tileSize; r++)
+		for(int c = 0; c < tileSize; c++)
+		{
+			int x = std::min(tx * tileSize + c, source.width - 1);
+			int z = std::min(tz * tileSize + r, source.height - 1);
+			std::memcpy(samples.data() + (static_cast<size_t>(r) * tileSize + c) * sampleSize,
+						source.samples + (static_cast<size_t>(z) * source.width + x) * sampleSize, sampleSize);
+		}
+
+		TiledHeightfieldEntry& entry = index[static_cast<size_t>(tz) * tilesAlongX + tx];
+		entry.offset = static_cast<uint64_t>(file.tellp());
+		if(compress)
+			encodeDeltas(samples.data(), tileSize, sampleSize, encoded);
+
+		if(compress && encoded.size() < tileBytes)
+		{
+			entry.storedBytes = static_cast<uint32_t>(encoded.size());
+			entry.compression = static_cast<uint32_t>(TileCompression::DeltaVarint);
+			file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+		}
+		else
+		{
+			entry.storedBytes = static_cast<uint32_t>(tileBytes);
+			entry.compression = static_cast<uint32_t>(TileCompression::None);
+			file.write(reinterpret_cast<const char*>(samples.data()), static_cast<std::streamsize>(tileBytes));
+		}
+	}
+
+	file.seekp(sizeof(header));
+	file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(TiledHeightfieldEntry)));
+	return static_cast<bool>(file);
+}
+
+bool TiledHeightfieldReader::open(const char* path, size_t cacheTiles)
+{
+	file.close();
+	file.clear();
+	file.open(path, std::ios::binary);
+	slots.clear();
+	slotOfTile.clear();
+	mostRecent = leastRecent = -1;
+	stats = TileCacheStats();
+	capacity = std::max<size_t>(cacheTiles, 1);
+
+	// Sizes are ints from here on, and empty maps have no sample to clamp to
+	const uint32_t maxDimension = static_cast<uint32_t>(std::numeric_limits<int>::max());
+	TiledHeightfieldHeader header;
+	if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+	   std::memcmp(header.magic, tiledMagic, sizeof(tiledMagic)) != 0 || header.version != tiledHeightfieldVersion ||
+	   header.format > static_cast<uint32_t>(HeightFormat::Float32) || header.tileSize == 0 ||
+	   header.width == 0 || header.height == 0 || header.width > maxDimension || header.height > maxDimension)
+	{
+		file.close();
+		return false;
+	}
+
+	width = static_cast<int>(header.width);
+	height = static_cast<int>(header.height);
+	tileSize = static_cast<int>(header.tileSize);
+	format = static_cast<HeightFormat>(header.format);
+	indexOffset = sizeof(header);
+	return true;
+}
+
+void TiledHeightfieldReader::unlink(int s)
+{
+	Slot& slot = slots[s];
+	if(slot.previous >= 0)
+		slots[slot.previous].next = slot.next;
+	else
+		mostRecent = slot.next;
+	if(slot.next >= 0)
+		slots[slot.next].previous = slot.previous;
+	else
+		leastRecent = slot.previous;
+	slot.previous = slot.next = -1;
+}
+
+void TiledHeightfieldReader::pushFront(int s)
+{
+	Slot& slot = slots[s];
+	slot.previous = -1;
+	slot.next = mostRecent;
+	if(mostRecent >= 0)
+		slots[mostRecent].previous = s;
+	mostRecent = s;
+	if(leastRecent < 0)
+		leastRecent = s;
+}
+
+bool TiledHeightfieldReader::load(int tile, Slot& slot)
+{
+	TiledHeightfieldEntry entry;
+	file.clear();
+	file.seekg(static_cast<std::streamoff>(indexOffset + static_cast<size_t>(tile) * sizeof(entry)));
+	if(!file.read(reinterpret_cast<char*>(&entry), sizeof(entry)))
+		return false;
+	stats.bytesRead += sizeof(entry);
+
+	size_t sampleSize = heightSampleSize(format);
+	size_t tileBytes = static_cast<size_t>(tileSize) * static_cast<size_t>(tileSize) * sampleSize;
+	slot.samples.resize(tileBytes);
+	file.seekg(static_cast<std::streamoff>(entry.offset));
+	stats.bytesRead += entry.storedBytes;
+
+	if(entry.compression == static_cast<uint32_t>(TileCompression::None))
+	{
+		return entry.storedBytes == tileBytes &&
+			   file.read(reinterpret_cast<char*>(slot.samples.data()), static_cast<std::streamsize>(tileBytes));
+	}
+	if(entry.compression == static_cast<uint32_t>(TileCompression::DeltaVarint))
+	{
+		stored.resize(entry.storedBytes);
+		return file.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(stored.size())) &&
+			   decodeDeltas(stored, tileSize, sampleSize, slot.samples.data());
+	}
+	return false;
+}
+
+HeightfieldView TiledHeightfieldReader::tile(int tx, int tz)
+{
+	if(!file.is_open() || tx < 0 || tz < 0 || tx >= tilesAlongX() || tz >= tilesAlongZ())
+		return HeightfieldView();
+
+	int t = tz * tilesAlongX() + tx;
+	auto found = slotOfTile.find(t);
+	int s;
+	if(found != slotOfTile.end())
+	{
+		stats.hits++;
+		s = found->second;
+		unlink(s);
+	}
+	else
+	{
+		stats.misses++;
+		if(slots.size() < capacity)
+		{
+			s = static_cast<int>(slots.size());
+			slots.emplace_back();
+		}
+		else
+		{
+			s = leastRecent;
+			unlink(s);
+			if(slots[s].tile >= 0)
+			{
+				slotOfTile.erase(slots[s].tile);
+				stats.evictions++;
+			}
+		}
+
+		// A tile that can't be read leaves its slot empty
+		slots[s].tile = -1;
+		if(!load(t, slots[s]))
+		{
+			pushFront(s);
+			return HeightfieldView();
+		}
+		slots[s].tile = t;
+		slotOfTile[t] = s;
+	}
+
+	pushFront(s);
+	return { tileSize, tileSize, format, slots[s].samples.data() };
+}
+
+float TiledHeightfieldReader::sample(int x, int z)
+{
+	x = std::clamp(x, 0, width - 1);
+	z = std::clamp(z, 0, height - 1);
+	HeightfieldView view = tile(x / tileSize, z / tileSize);
+	return view.empty() ? 0.0f : view.sample(x % tileSize, z % tileSize);
+}
+
+void TiledHeightfieldReader::readRegion(int x, int z, int w, int h, float* out)
+{
+	if(w <= 0 || h <= 0 || width <= 0 || height <= 0)
+		return;
+
+	// Region rows and columns clamp to the map, so those over tile t along
+	// an axis are one contiguous range
+	auto range = [&](int origin, int count, int size, int t, int& first, int& last)
+	{
+		int low = t * tileSize, high = std::min(low + tileSize, size) - 1;
+		first = std::clamp(low == 0 ? 0 : low - origin, 0, count);
+		last = std::clamp(high == size - 1 ? count : high - origin + 1, 0, count);
+	};
+
+	int firstTx = std::clamp(x, 0, width - 1) / tileSize, lastTx = std::clamp(x + w - 1, 0, width - 1) / tileSize;
+	int firstTz = std::clamp(z, 0, height - 1) / tileSize, lastTz = std::clamp(z + h - 1, 0, height - 1) / tileSize;
+	for(int tz = firstTz; tz <= lastTz; tz++)
+	for(int tx = firstTx; tx <= lastTx; tx++)
+	{
+		HeightfieldView view = tile(tx, tz);
+		int firstRow, lastRow, firstColumn, lastColumn;
+		range(z, h, height, tz, firstRow, lastRow);
+		range(x, w, width, tx, firstColumn, lastColumn);
+		for(int r = firstRow; r < lastRow; r++)
+		{
+			int localZ = std::clamp(z + r, 0, height - 1) - tz * tileSize;
+			float* row = out + static_cast<size_t>(r) * static_cast<size_t>(w);
+			for(int c = firstColumn; c < lastColumn; c++)
+			{
+				int localX = std::clamp(x + c, 0, width - 1) - tx * tileSize;
+				row[c] = view.empty() ? 0.0f : view.sample(localX, localZ);
+			}
+		}
+	}
+}
+
+HeightGrid TiledHeightfieldReader::readGrid(int x, int z, int w, int h)
+{
+	HeightGrid grid(w, h);
+	readRegion(x, z, w, h, grid.texels.data());
+	return grid;
+}
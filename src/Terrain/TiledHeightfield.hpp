@@ -0,0 +1,115 @@
+#pragma once
+#include "Heightfield.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+// How one tile's samples are stored in a tiled heightfield file
+enum class TileCompression : uint32_t
+{
+	None,			// The samples as they are
+	DeltaVarint		// Differences to the sample before, or above at row starts, zigzag and LEB128 encoded
+};
+
+// Tiled heightfield files hold maps larger than memory as square tiles of
+// tileSize x tileSize samples, edge tiles padded with their last row and
+// column. After the header comes an index with one TiledHeightfieldEntry
+// per tile, row of tiles by row of tiles, then the tiles themselves.
+struct TiledHeightfieldHeader
+{
+	char magic[4];		// "ITTT"
+	uint32_t version;	// tiledHeightfieldVersion
+	uint32_t width;
+	uint32_t height;
+	uint32_t tileSize;
+	uint32_t format;	// A HeightFormat
+};
+
+struct TiledHeightfieldEntry
+{
+	uint64_t offset;		// From the start of the file
+	uint32_t storedBytes;
+	uint32_t compression;	// A TileCompression
+};
+
+constexpr uint32_t tiledHeightfieldVersion = 1;
+
+// Writes source as tiles of tileSize samples, each compressed when that
+// makes it smaller. Reads source one row of tiles at a time, so a mapped
+// raw heightmap is converted without loading it whole. False if the file
+// can't be written.
+bool writeTiledHeightfield(const char* path, const HeightfieldView& source, int tileSize, bool compress = true);
+
+// What a TiledHeightfieldReader's cache did since it was opened
+struct TileCacheStats
+{
+	size_t hits = 0;
+	size_t misses = 0;
+	size_t evictions = 0;
+	size_t bytesRead = 0;	// From the file, compressed tiles and index entries
+};
+
+// Reads a tiled heightfield through an LRU cache of decoded tiles, so its
+// memory stays at cacheTiles tiles however large the map is. Index entries
+// are read along with their tile instead of being kept. Not thread-safe.
+struct TiledHeightfieldReader
+{
+	int width = 0;
+	int height = 0;
+	int tileSize = 0;
+	HeightFormat format = HeightFormat::UNorm8;
+	TileCacheStats stats;
+
+	// Opens path with room for cacheTiles decoded tiles, false if it isn't a
+	// tiled heightfield of this version
+	bool open(const char* path, size_t cacheTiles);
+
+	int tilesAlongX() const
+	{
+		return (width + tileSize - 1) / tileSize;
+	}
+
+	int tilesAlongZ() const
+	{
+		return (height + tileSize - 1) / tileSize;
+	}
+
+	// Tile (tx, tz) as tileSize x tileSize samples, loading it on a miss.
+	// Valid until a later call evicts it. Empty if it can't be read.
+	HeightfieldView tile(int tx, int tz);
+
+	// Sample (x, z) clamped to the map, in [0, 1] for the normalized formats
+	float sample(int x, int z);
+
+	// Samples of the w x h region at (x, z), clamped to the map, into out
+	// row by row, visiting each tile the region covers once
+	void readRegion(int x, int z, int w, int h, float* out);
+
+	// readRegion() as a HeightGrid, for meshing a window of the map
+	HeightGrid readGrid(int x, int z, int w, int h);
+
+private:
+	// Slots are linked from most to least recently used
+	struct Slot
+	{
+		int tile = -1;
+		int previous = -1;
+		int next = -1;
+		std::vector<unsigned char> samples;
+	};
+
+	std::ifstream file;
+	size_t indexOffset = 0;
+	size_t capacity = 0;
+	std::vector<Slot> slots;
+	std::unordered_map<int, int> slotOfTile;
+	std::vector<unsigned char> stored;	// A tile as read from the file
+	int mostRecent = -1;
+	int leastRecent = -1;
+
+	void unlink(int s);
+	void pushFront(int s);
+	bool load(int tile, Slot& slot);
+};
@@ -0,0 +1,85 @@
+#include "VertexCache.hpp"
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+double VertexCacheStats::acmr() const
+{
+	return triangles == 0 ? 0.0 : static_cast<double>(transforms) / static_cast<double>(triangles);
+}
+
+double VertexCacheStats::atvr() const
+{
+	return vertices == 0 ? 0.0 : static_cast<double>(transforms) / static_cast<double>(vertices);
+}
+
+namespace
+{
+	template<typename Index>
+	VertexCacheStats simulateCache(const Index* indices, size_t count, PrimitiveMode mode, int cacheSize, bool lru)
+	{
+		VertexCacheStats stats;
+
+		// Cached vertices, most recent first, searched linearly like the hardware would
+		std::vector<Index> cache;
+		cache.reserve(static_cast<size_t>(cacheSize) + 1);
+		std::unordered_set<Index> seen;
+
+		size_t stripLength = 0;
+		for(size_t k = 0; k < count; k++)
+		{
+			Index index = indices[k];
+			if(mode == PrimitiveMode::TriangleStrip && index == restartIndex<Index>())
+			{
+				stripLength = 0;
+				continue;
+			}
+
+			auto hit = std::find(cache.begin(), cache.end(), index);
+			if(hit == cache.end())
+			{
+				cache.insert(cache.begin(), index);
+				if(cache.size() > static_cast<size_t>(cacheSize))
+					cache.pop_back();
+				stats.transforms++;
+			}
+			else if(lru)
+			{
+				std::rotate(cache.begin(), hit, hit + 1);
+			}
+			seen.insert(index);
+
+			if(mode == PrimitiveMode::Triangles)
+			{
+				if(k % 3 == 2)
+					stats.triangles++;
+			}
+			else if(++stripLength >= 3)
+			{
+				Index a = indices[k - 2], b = indices[k - 1];
+				if(a != b && b != index && a != index)
+					stats.triangles++;
+			}
+		}
+
+		stats.vertices = seen.size();
+		return stats;
+	}
+}
+
+template<typename Index>
+VertexCacheStats simulateFifoCache(const Index* indices, size_t count, PrimitiveMode mode, int cacheSize)
+{
+	return simulateCache(indices, count, mode, cacheSize, false);
+}
+
+template<typename Index>
+VertexCacheStats simulateLruCache(const Index* indices, size_t count, PrimitiveMode mode, int cacheSize)
+{
+	return simulateCache(indices, count, mode, cacheSize, true);
+}
+
+template VertexCacheStats simulateFifoCache<unsigned int>(const unsigned int*, size_t, PrimitiveMode, int);
+template VertexCacheStats simulateFifoCache<uint16_t>(const uint16_t*, size_t, PrimitiveMode, int);
+template VertexCacheStats simulateLruCache<unsigned int>(const unsigned int*, size_t, PrimitiveMode, int);
+template VertexCacheStats simulateLruCache<uint16_t>(const uint16_t*, size_t, PrimitiveMode, int);
@@ -0,0 +1,32 @@
+#pragma once
+#include "GridIndices.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Result of running an index buffer through a simulated post-transform cache
+struct VertexCacheStats
+{
+	size_t triangles = 0;
+	size_t vertices = 0;	// Distinct vertices referenced
+	size_t transforms = 0;	// Cache misses, i.e. vertex shader invocations
+
+	// Average cache miss ratio: transforms per triangle, 0.5 at best on a grid
+	double acmr() const;
+
+	// Average transform to vertex ratio: 1.0 means every vertex is shaded once
+	double atvr() const;
+};
+
+// Simulates a FIFO post-transform cache of cacheSize entries. Strips are
+// split at restartIndex<Index>() and degenerate triangles are not counted.
+template<typename Index>
+VertexCacheStats simulateFifoCache(const Index* indices, size_t count, PrimitiveMode mode, int cacheSize);
+
+// Same as simulateFifoCache(), but hits move a vertex back to the front
+template<typename Index>
+VertexCacheStats simulateLruCache(const Index* indices, size_t count, PrimitiveMode mode, int cacheSize);
+
+extern template VertexCacheStats simulateFifoCache<unsigned int>(const unsigned int*, size_t, PrimitiveMode, int);
+extern template VertexCacheStats simulateFifoCache<uint16_t>(const uint16_t*, size_t, PrimitiveMode, int);
+extern template VertexCacheStats simulateLruCache<unsigned int>(const unsigned int*, size_t, PrimitiveMode, int);
+extern template VertexCacheStats simulateLruCache<uint16_t>(const uint16_t*, size_t, PrimitiveMode, int);
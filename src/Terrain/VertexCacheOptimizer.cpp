@@ -0,0 +1,173 @@
+#include "VertexCacheOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	const int maxCacheSize = 64;
+	const int maxValence = 32;
+
+	const float lastTriangleScore = 0.75f;
+	const float cacheDecayPower = 1.5f;
+	const float valenceBoostScale = 2.0f;
+	const float valenceBoostPower = 0.5f;
+
+	struct ScoreTables
+	{
+		float cache[maxCacheSize + 3];
+		float valence[maxValence + 1];
+
+		explicit ScoreTables(int cacheSize)
+		{
+			for(int position = 0; position < maxCacheSize + 3; position++)
+			{
+				if(position < 3)
+					cache[position] = lastTriangleScore;	// Vertices of the last triangle
+				else if(position < cacheSize)
+					cache[position] = std::pow(1.0f - static_cast<float>(position - 3) / static_cast<float>(cacheSize - 3), cacheDecayPower);
+				else
+					cache[position] = 0.0f;
+			}
+
+			valence[0] = 0.0f;
+			for(int v = 1; v <= maxValence; v++)
+				valence[v] = valenceBoostScale * std::pow(static_cast<float>(v), -valenceBoostPower);
+		}
+
+		float score(int cachePosition, unsigned int liveTriangles) const
+		{
+			// Vertices without triangles left never need to be picked again
+			if(liveTriangles == 0)
+				return -1.0f;
+
+			float result = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+			return result + valence[std::min<unsigned int>(liveTriangles, maxValence)];
+		}
+	};
+}
+
+template<typename Index>
+void optimizeVertexCache(Index* indices, size_t indexCount, size_t vertexCount, int cacheSize)
+{
+	size_t triangleCount = indexCount / 3;
+	if(triangleCount < 2)
+		return;
+
+	cacheSize = std::max(4, std::min(cacheSize, maxCacheSize));
+	ScoreTables tables(cacheSize);
+
+	// Triangles around each vertex, compressed into one array. The live
+	// triangles of vertex v are kept at the front of its range.
+	std::vector<unsigned int> liveTriangles(vertexCount, 0);
+	for(size_t k = 0; k < triangleCount * 3; k++)
+		liveTriangles[indices[k]]++;
+
+	std::vector<size_t> firstTriangle(vertexCount + 1, 0);
+	for(size_t v = 0; v < vertexCount; v++)
+		firstTriangle[v + 1] = firstTriangle[v] + liveTriangles[v];
+
+	std::vector<unsigned int> vertexTriangles(triangleCount * 3);
+	{
+		std::vector<size_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+		for(size_t t = 0; t < triangleCount; t++)
+			for(size_t c = 0; c < 3; c++)
+				vertexTriangles[fill[indices[t * 3 + c]]++] = static_cast<unsigned int>(t);
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for(size_t v = 0; v < vertexCount; v++)
+		vertexScore[v] = tables.score(-1, liveTriangles[v]);
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<Index> output(triangleCount * 3);
+
+	// LRU cache with room for the 3 vertices pushed in by each new triangle
+	std::vector<Index> cache, nextCache;
+	cache.reserve(static_cast<size_t>(cacheSize) + 3);
+	nextCache.reserve(static_cast<size_t>(cacheSize) + 3);
+
+	size_t bestTriangle = 0;
+	size_t cursor = 0;
+	for(size_t out = 0; out < triangleCount; out++)
+	{
+		// Nothing in the cache has triangles left, continue in input order
+		if(bestTriangle == triangleCount)
+		{
+			while(emitted[cursor])
+				cursor++;
+			bestTriangle = cursor;
+		}
+
+		const Index* corners = indices + bestTriangle * 3;
+		emitted[bestTriangle] = true;
+
+		nextCache.clear();
+		for(size_t c = 0; c < 3; c++)
+		{
+			Index v = corners[c];
+			output[out * 3 + c] = v;
+			nextCache.push_back(v);
+
+			// Move the triangle out of v's live range
+			size_t begin = firstTriangle[v];
+			size_t end = begin + liveTriangles[v];
+			for(size_t k = begin; k < end; k++)
+			{
+				if(vertexTriangles[k] == bestTriangle)
+				{
+					std::swap(vertexTriangles[k], vertexTriangles[end - 1]);
+					break;
+				}
+			}
+			liveTriangles[v]--;
+		}
+
+		for(Index v : cache)
+			if(v != corners[0] && v != corners[1] && v != corners[2])
+				nextCache.push_back(v);
+		std::swap(cache, nextCache);
+
+		// Vertices pushed out of the cache lose their cache score
+		for(size_t position = static_cast<size_t>(cacheSize); position < cache.size(); position++)
+		{
+			Index v = cache[position];
+			cachePosition[v] = -1;
+			vertexScore[v] = tables.score(-1, liveTriangles[v]);
+		}
+		if(cache.size() > static_cast<size_t>(cacheSize))
+			cache.resize(static_cast<size_t>(cacheSize));
+
+		for(size_t position = 0; position < cache.size(); position++)
+		{
+			Index v = cache[position];
+			cachePosition[v] = static_cast<int>(position);
+			vertexScore[v] = tables.score(static_cast<int>(position), liveTriangles[v]);
+		}
+
+		// Rescore the triangles around the cache and pick the best of them
+		bestTriangle = triangleCount;
+		float bestScore = -1.0f;
+		for(Index v : cache)
+		{
+			size_t begin = firstTriangle[v];
+			size_t end = begin + liveTriangles[v];
+			for(size_t k = begin; k < end; k++)
+			{
+				unsigned int t = vertexTriangles[k];
+				float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if(score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = t;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+template void optimizeVertexCache<unsigned int>(unsigned int*, size_t, size_t, int);
+template void optimizeVertexCache<uint16_t>(uint16_t*, size_t, size_t, int);
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Reorders the triangles of a triangle list for post-transform cache reuse,
+// after Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". Vertices
+// recently used and vertices with few triangles left score highest, and
+// the best scoring triangle around the simulated LRU cache is emitted next.
+// Works in place on any triangle list indexing fewer than vertexCount vertices.
+template<typename Index>
+void optimizeVertexCache(Index* indices, size_t indexCount, size_t vertexCount, int cacheSize = 32);
+
+extern template void optimizeVertexCache<unsigned int>(unsigned int*, size_t, size_t, int);
+extern template void optimizeVertexCache<uint16_t>(uint16_t*, size_t, size_t, int);
@@ -0,0 +1,376 @@
+#pragma once
+#include "Arena.hpp"
+#include "Half.hpp"
+#include "TerrainMesh.hpp"
+#include "../Util/Parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+enum class AttributeType
+{
+	Float,
+	Int16,
+	UInt16,
+	HalfFloat
+};
+
+inline size_t attributeTypeSize(AttributeType type)
+{
+	return type == AttributeType::Float ? sizeof(float) : sizeof(uint16_t);
+}
+
+// What an attribute feeds in basicV.glsl
+enum class AttributeRole
+{
+	Position,
+	TexCoord,
+	Height
+};
+
+// Runtime description of one attribute, used to set up vertex arrays
+struct VertexAttribute
+{
+	unsigned int location;
+	int components;
+	AttributeType type;
+	bool normalized;
+	unsigned int buffer;	// Index of the vertex buffer holding the attribute
+	size_t offset;			// Byte offset inside one vertex of that buffer
+	size_t stride;			// Bytes between consecutive vertices of that buffer
+};
+
+// Attributes pair a shader location and storage format with the
+// function that encodes a grid vertex into it. Formats that basicV.glsl
+// can't read by default name the #define selecting their shader variant.
+struct PositionAttribute
+{
+	using Component = float;
+	static constexpr unsigned int location = 0;
+	static constexpr int components = 3;
+	static constexpr AttributeType type = AttributeType::Float;
+	static constexpr bool normalized = false;
+	static constexpr AttributeRole role = AttributeRole::Position;
+	static constexpr const char* shaderDefine = nullptr;
+	static constexpr int maxGridCoordinate = 1 << 24;	// Largest integer a float holds exactly
+
+	static void encode(const GridVertex& v, Component* out)
+	{
+		out[0] = v.x;
+		out[1] = v.y;
+		out[2] = v.z;
+	}
+};
+
+struct TexCoordAttribute
+{
+	using Component = float;
+	static constexpr unsigned int location = 1;
+	static constexpr int components = 2;
+	static constexpr AttributeType type = AttributeType::Float;
+	static constexpr bool normalized = false;
+	static constexpr AttributeRole role = AttributeRole::TexCoord;
+	static constexpr const char* shaderDefine = nullptr;
+	static constexpr int maxGridCoordinate = std::numeric_limits<int>::max();
+
+	static void encode(const GridVertex& v, Component* out)
+	{
+		out[0] = v.u;
+		out[1] = v.v;
+	}
+};
+
+// Grid x and z as 16-bit integers, for grids up to 32767 or 65535 texels
+// wide. Layouts with them refuse to build larger grids, see fitsGrid().
+template<typename Integer, AttributeType Type>
+struct GridPositionAttribute
+{
+	using Component = Integer;
+	static constexpr unsigned int location = 0;
+	static constexpr int components = 2;
+	static constexpr AttributeType type = Type;
+	static constexpr bool normalized = false;
+	static constexpr AttributeRole role = AttributeRole::Position;
+	static constexpr const char* shaderDefine = "GRID_POSITIONS";
+	static constexpr int maxGridCoordinate = std::numeric_limits<Integer>::max();
+
+	static void encode(const GridVertex& v, Component* out)
+	{
+		out[0] = static_cast<Component>(v.x);
+		out[1] = static_cast<Component>(v.z);
+	}
+};
+
+using GridPositionI16Attribute = GridPositionAttribute<int16_t, AttributeType::Int16>;
+using GridPositionU16Attribute = GridPositionAttribute<uint16_t, AttributeType::UInt16>;
+
+// Texcoords as normalized 16-bit integers
+struct TexCoordUNorm16Attribute
+{
+	using Component = uint16_t;
+	static constexpr unsigned int location = 1;
+	static constexpr int components = 2;
+	static constexpr AttributeType type = AttributeType::UInt16;
+	static constexpr bool normalized = true;
+	static constexpr AttributeRole role = AttributeRole::TexCoord;
+	static constexpr const char* shaderDefine = nullptr;
+	static constexpr int maxGridCoordinate = std::numeric_limits<int>::max();
+
+	static void encode(const GridVertex& v, Component* out)
+	{
+		out[0] = static_cast<Component>(std::lround(v.u * 65535.0f));
+		out[1] = static_cast<Component>(std::lround(v.v * 65535.0f));
+	}
+};
+
+// Heightmap value baked into the vertex as a half float, so the
+// vertex shader doesn't have to sample the heightmap texture
+struct BakedHeightAttribute
+{
+	using Component = uint16_t;
+	static constexpr unsigned int location = 2;
+	static constexpr int components = 1;
+	static constexpr AttributeType type = AttributeType::HalfFloat;
+	static constexpr bool normalized = false;
+	static constexpr AttributeRole role = AttributeRole::Height;
+	static constexpr const char* shaderDefine = "BAKED_HEIGHTS";
+	static constexpr int maxGridCoordinate = std::numeric_limits<int>::max();
+
+	static void encode(const GridVertex& v, Component* out)
+	{
+		out[0] = floatToHalf(v.height + v.y);
+	}
+};
+
+template<typename Attribute>
+constexpr size_t attributeSize()
+{
+	return sizeof(typename Attribute::Component) * Attribute::components;
+}
+
+template<typename Attribute>
+VertexAttribute describeAttribute(unsigned int buffer, size_t offset, size_t stride)
+{
+	return { Attribute::location, Attribute::components, Attribute::type, Attribute::normalized, buffer, offset, stride };
+}
+
+template<typename Attribute>
+void encodeAttribute(const GridVertex& v, unsigned char* out)
+{
+	typename Attribute::Component values[Attribute::components];
+	Attribute::encode(v, values);
+	std::memcpy(out, values, sizeof(values));
+}
+
+// Shader #defines that make basicV.glsl read the given attributes
+template<typename... Attributes>
+std::vector<std::string> collectShaderDefines()
+{
+	std::vector<std::string> defines;
+	((Attributes::shaderDefine != nullptr ? defines.push_back(Attributes::shaderDefine) : void()), ...);
+	if(!((Attributes::role == AttributeRole::TexCoord) || ...))
+		defines.push_back("DERIVE_TEXCOORDS");
+	return defines;
+}
+
+// All attributes interleaved in a single buffer (array of structures)
+template<typename... Attributes>
+struct InterleavedLayout
+{
+	static constexpr size_t attributeCount = sizeof...(Attributes);
+	static constexpr size_t bufferCount = 1;
+	static constexpr size_t stride = (attributeSize<Attributes>() + ...);
+
+	template<AttributeRole Role>
+	static constexpr bool has = ((Attributes::role == Role) || ...);
+
+	// Whether GridVertex::y reaches the shader, through a full position or a baked height
+	static constexpr bool carriesHeightOffset =
+		((Attributes::role == AttributeRole::Position && Attributes::components == 3) || ...) || has<AttributeRole::Height>;
+
+	// Widest grid whose corner coordinates every attribute can hold
+	static constexpr int maxGridSize = std::min({ Attributes::maxGridCoordinate... });
+
+	static constexpr bool fitsGrid(int width, int height)
+	{
+		return width <= maxGridSize && height <= maxGridSize;
+	}
+
+	static constexpr size_t bufferStride(size_t)
+	{
+		return stride;
+	}
+
+	static std::vector<std::string> shaderDefines()
+	{
+		return collectShaderDefines<Attributes...>();
+	}
+
+	static std::array<VertexAttribute, attributeCount> attributes()
+	{
+		std::array<VertexAttribute, attributeCount> result{};
+		size_t i = 0, offset = 0;
+		((result[i++] = describeAttribute<Attributes>(0, offset, stride), offset += attributeSize<Attributes>()), ...);
+		return result;
+	}
+
+	static void write(unsigned char* const* buffers, size_t index, const GridVertex& v)
+	{
+		unsigned char* out = buffers[0] + index * stride;
+		((encodeAttribute<Attributes>(v, out), out += attributeSize<Attributes>()), ...);
+	}
+};
+
+// Every attribute in its own tightly packed buffer (structure of arrays)
+template<typename... Attributes>
+struct SeparateLayout
+{
+	static constexpr size_t attributeCount = sizeof...(Attributes);
+	static constexpr size_t bufferCount = sizeof...(Attributes);
+
+	template<AttributeRole Role>
+	static constexpr bool has = ((Attributes::role == Role) || ...);
+
+	// Whether GridVertex::y reaches the shader, through a full position or a baked height
+	static constexpr bool carriesHeightOffset =
+		((Attributes::role == AttributeRole::Position && Attributes::components == 3) || ...) || has<AttributeRole::Height>;
+
+	// Widest grid whose corner coordinates every attribute can hold
+	static constexpr int maxGridSize = std::min({ Attributes::maxGridCoordinate... });
+
+	static constexpr bool fitsGrid(int width, int height)
+	{
+		return width <= maxGridSize && height <= maxGridSize;
+	}
+
+	static constexpr size_t bufferStride(size_t buffer)
+	{
+		const size_t strides[] = { attributeSize<Attributes>()... };
+		return strides[buffer];
+	}
+
+	static std::vector<std::string> shaderDefines()
+	{
+		return collectShaderDefines<Attributes...>();
+	}
+
+	static std::array<VertexAttribute, attributeCount> attributes()
+	{
+		std::array<VertexAttribute, attributeCount> result{};
+		unsigned int i = 0;
+		((result[i] = describeAttribute<Attributes>(i, 0, attributeSize<Attributes>()), i++), ...);
+		return result;
+	}
+
+	static void write(unsigned char* const* buffers, size_t index, const GridVertex& v)
+	{
+		size_t i = 0;
+		((encodeAttribute<Attributes>(v, buffers[i] + index * attributeSize<Attributes>()), i++), ...);
+	}
+};
+
+// Full precision formats, 20 or 12 bytes per vertex
+using AoSLayout = InterleavedLayout<PositionAttribute, TexCoordAttribute>;
+using SoALayout = SeparateLayout<PositionAttribute, TexCoordAttribute>;
+using PositionOnlyLayout = InterleavedLayout<PositionAttribute>;
+
+// Quantized formats, 8, 4 and 6 bytes per vertex
+using QuantizedLayout = InterleavedLayout<GridPositionU16Attribute, TexCoordUNorm16Attribute>;
+using GridOnlyLayout = InterleavedLayout<GridPositionU16Attribute>;
+using BakedHeightLayout = InterleavedLayout<GridPositionU16Attribute, BakedHeightAttribute>;
+
+// Whether a width x height grid can be encoded with Layout, with a message if not
+template<typename Layout>
+bool layoutFitsGrid(int width, int height)
+{
+	if(Layout::fitsGrid(width, height))
+		return true;
+
+	std::cout << "Terrain is too large for this vertex format's grid positions (" << width << "x" << height
+			  << ", at most " << Layout::maxGridSize << "), use a full precision layout instead" << std::endl;
+	return false;
+}
+
+// Terrain geometry encoded with Layout, pointing into an Arena
+template<typename Layout>
+struct LayoutMeshView
+{
+	Span<unsigned char> buffers[Layout::bufferCount];
+	Span<unsigned int> indices;
+	size_t vertexCount = 0;
+	PrimitiveMode primitive = PrimitiveMode::Triangles;
+
+	size_t byteSize() const
+	{
+		size_t total = indices.bytes();
+		for(const Span<unsigned char>& buffer : buffers)
+			total += buffer.bytes();
+		return total;
+	}
+};
+
+template<typename Layout>
+size_t layoutArenaBytes(const TerrainMeshBuilder& builder)
+{
+	size_t total = Arena::alignedSize(builder.indexCount() * sizeof(unsigned int));
+	for(size_t b = 0; b < Layout::bufferCount; b++)
+		total += Arena::alignedSize(builder.vertexCount() * Layout::bufferStride(b));
+	return total;
+}
+
+// Builds the builder's grid in the given vertex format. The separate
+// position/texcoord format maps directly onto the builder's own SIMD kernels.
+template<typename Layout>
+LayoutMeshView<Layout> buildLayoutMesh(const TerrainMeshBuilder& builder, Arena& arena)
+{
+	LayoutMeshView<Layout> mesh;
+	if(!builder.fitsUInt32Indices())
+	{
+		std::cout << "Terrain is too large for 32-bit indices, use TerrainTiler instead" << std::endl;
+		return mesh;
+	}
+	if(!layoutFitsGrid<Layout>(builder.width, builder.height))
+		return mesh;
+
+	mesh.vertexCount = builder.vertexCount();
+	mesh.primitive = builder.primitive;
+
+	if constexpr(std::is_same_v<Layout, SoALayout>)
+	{
+		TerrainMeshView view = builder.build(arena);
+		mesh.buffers[0] = { reinterpret_cast<unsigned char*>(view.positions.data), view.positions.bytes() };
+		mesh.buffers[1] = { reinterpret_cast<unsigned char*>(view.texCoords.data), view.texCoords.bytes() };
+		mesh.indices = view.indices;
+		return mesh;
+	}
+	else
+	{
+		unsigned char* buffers[Layout::bufferCount];
+		for(size_t b = 0; b < Layout::bufferCount; b++)
+		{
+			mesh.buffers[b] = arena.allocate<unsigned char>(mesh.vertexCount * Layout::bufferStride(b));
+			buffers[b] = mesh.buffers[b].data;
+		}
+		mesh.indices = arena.allocate<unsigned int>(builder.indexCount());
+
+		const bool withHeight = Layout::template has<AttributeRole::Height>;
+		parallelFor(static_cast<size_t>(builder.width + 1), builder.threadCount, [&](size_t first, size_t last)
+		{
+			for(size_t i = first; i < last; i++)
+			for(int j = 0; j <= builder.height; j++)
+			{
+				size_t index = i * static_cast<size_t>(builder.height + 1) + static_cast<size_t>(j);
+				Layout::write(buffers, index, builder.gridVertex(static_cast<int>(i), j, withHeight));
+			}
+		});
+		builder.writeIndices(mesh.indices.data);
+		return mesh;
+	}
+}
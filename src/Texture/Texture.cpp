@@ -1,5 +1,7 @@
 #include "Texture.hpp"
+#include "../Terrain/Heightfield.hpp"
 #include <GL/glew.h>
+#include <cstddef>
 
 Texture::Texture(unsigned char* data, int index, int width, int height)
 	: index(index), width(width), height(height)
@@ -18,6 +20,39 @@ Texture::Texture(unsigned char* data, int index, int width, int height)
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+Texture::Texture(const HeightfieldView& heights, int index)
+	: index(index), width(heights.width), height(heights.height)
+{
+	GLenum internalFormat = GL_R8, type = GL_UNSIGNED_BYTE;
+	if(heights.format == HeightFormat::UNorm16)
+	{
+		internalFormat = GL_R16;
+		type = GL_UNSIGNED_SHORT;
+	}
+	else if(heights.format == HeightFormat::Float32)
+	{
+		internalFormat = GL_R32F;
+		type = GL_FLOAT;
+	}
+
+	glGenTextures(1, &texture);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// Rows of 8 and 16-bit samples aren't padded to 4 bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RED, type,
+				 heights.samples);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Texture::bind()
 {
 	glActiveTexture(GL_TEXTURE0 + index);
@@ -29,3 +64,48 @@ void Texture::unbind()
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
+
+HeightTextureArray::HeightTextureArray(int index, int width, int height, int layers)
+	: index(index), width(width), height(height), layers(layers)
+{
+	glGenTextures(1, &texture);
+
+	glActiveTexture(GL_TEXTURE0 + index);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+	// Texels are fetched directly, never filtered
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R32F, width, height, layers);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void HeightTextureArray::update(int layer, int x, int y, int w, int h, const float* layerData)
+{
+	glActiveTexture(GL_TEXTURE0 + index);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, layer, w, h, 1, GL_RED, GL_FLOAT,
+					layerData + static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x));
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void HeightTextureArray::bind()
+{
+	glActiveTexture(GL_TEXTURE0 + index);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+}
+
+void HeightTextureArray::unbind()
+{
+	glActiveTexture(GL_TEXTURE0 + index);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
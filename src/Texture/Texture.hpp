@@ -1,5 +1,7 @@
 #pragma once
 
+struct HeightfieldView;
+
 struct Texture
 {
 	unsigned int texture;
@@ -11,6 +13,29 @@ struct Texture
 
     Texture(unsigned char* data, int index, int width, int height);
 
+	// Single channel in the heightfield's own precision: GL_R8, GL_R16 or GL_R32F
+	Texture(const HeightfieldView& heights, int index);
+
+	void bind();
+	void unbind();
+};
+
+// Layers of single-channel float texels, for heights streamed in from the CPU
+struct HeightTextureArray
+{
+	unsigned int texture;
+
+	int index;
+	int width;
+	int height;
+	int layers;
+
+	HeightTextureArray(int index, int width, int height, int layers);
+
+	// Copies a rectangle of layer from layerData, which holds all of the
+	// layer's texels row by row
+	void update(int layer, int x, int y, int w, int h, const float* layerData);
+
 	void bind();
 	void unbind();
 };
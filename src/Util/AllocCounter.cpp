@@ -0,0 +1,96 @@
+#include "AllocCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace
+{
+	std::atomic<size_t> allocationCount{0};
+	std::atomic<size_t> allocatedBytes{0};
+}
+
+#ifdef ITT_COUNT_ALLOCATIONS
+static void* countedAlloc(size_t size, size_t alignment)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+	if(size == 0)
+		size = 1;
+
+	void* ptr;
+	if(alignment > alignof(std::max_align_t))
+		ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+	else
+		ptr = std::malloc(size);
+
+	if(ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(size_t size)
+{
+	return countedAlloc(size, 0);
+}
+
+void* operator new[](size_t size)
+{
+	return countedAlloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+#endif
+
+namespace AllocCounter
+{
+	bool enabled()
+	{
+#ifdef ITT_COUNT_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	Stats snapshot()
+	{
+		Stats stats;
+		stats.allocations = allocationCount.load(std::memory_order_relaxed);
+		stats.bytes = allocatedBytes.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	Scope::Scope(const char* stage)
+		: stage(stage), start(snapshot())
+	{
+	}
+
+	Scope::~Scope()
+	{
+		if(!enabled())
+			return;
+
+		Stats end = snapshot();
+		std::cout << "[alloc] " << stage << ": " << end.allocations - start.allocations
+				  << " allocations, " << end.bytes - start.bytes << " bytes" << std::endl;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+// Counts global operator new calls. The counting hooks are only compiled
+// in when ITT_COUNT_ALLOCATIONS is defined (the debug/bench configuration),
+// otherwise every count stays at zero.
+namespace AllocCounter
+{
+	struct Stats
+	{
+		size_t allocations = 0;
+		size_t bytes = 0;
+	};
+
+	bool enabled();
+	Stats snapshot();
+
+	// Prints the allocations made between construction and destruction
+	struct Scope
+	{
+		const char* stage;
+		Stats start;
+
+		explicit Scope(const char* stage);
+		~Scope();
+	};
+}
@@ -0,0 +1,97 @@
+#include "MappedFile.hpp"
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ITT_HAS_MMAP
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if(this != &other)
+	{
+		close();
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef ITT_HAS_MMAP
+bool MappedFile::open(const char* path)
+{
+	close();
+
+	int fd = ::open(path, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat info;
+	if(fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// The mapping keeps the file alive on its own
+	void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(mapped == MAP_FAILED)
+		return false;
+
+	data = static_cast<const unsigned char*>(mapped);
+	size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if(data != nullptr)
+		munmap(const_cast<unsigned char*>(data), size);
+	data = nullptr;
+	size = 0;
+}
+
+void MappedFile::advise(MappedAccess access, size_t offset, size_t bytes) const
+{
+	if(data == nullptr || offset >= size)
+		return;
+
+	size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t start = offset / page * page;
+	size_t end = offset + bytes < size ? offset + bytes : size;
+
+	int advice = access == MappedAccess::Sequential ? MADV_SEQUENTIAL :
+				 access == MappedAccess::Random ? MADV_RANDOM : MADV_WILLNEED;
+	madvise(const_cast<unsigned char*>(data) + start, end - start, advice);
+}
+#else
+bool MappedFile::open(const char*)
+{
+	close();
+	return false;
+}
+
+void MappedFile::close()
+{
+	data = nullptr;
+	size = 0;
+}
+
+void MappedFile::advise(MappedAccess, size_t, size_t) const
+{
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+
+// How a mapping's pages will be read, passed on to the kernel as madvise() hints
+enum class MappedAccess
+{
+	Sequential,	// Front to back once, read ahead aggressively and drop pages behind
+	Random,		// Scattered reads, don't read ahead
+	WillNeed	// Start reading the range in now
+};
+
+// A whole file mapped read-only. Opening costs the same for any file size,
+// pages are only read from disk when they're first touched. Only
+// implemented on POSIX systems, open() fails elsewhere.
+struct MappedFile
+{
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	~MappedFile();
+
+	// Replaces the current mapping, false if path can't be mapped
+	bool open(const char* path);
+	void close();
+
+	// Hints for bytes starting at offset, which is rounded down to a page
+	void advise(MappedAccess access, size_t offset, size_t bytes) const;
+
+	void advise(MappedAccess access) const
+	{
+		advise(access, 0, size);
+	}
+};
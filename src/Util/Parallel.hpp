@@ -0,0 +1,44 @@
+#pragma once
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+// Number of hardware threads, never less than one
+inline unsigned defaultThreadCount()
+{
+	unsigned count = std::thread::hardware_concurrency();
+	return count == 0 ? 1 : count;
+}
+
+// Splits [0, count) into threadCount contiguous bands and runs
+// fn(begin, end) for each of them. The calling thread takes the first band.
+template<typename Fn>
+void parallelFor(size_t count, unsigned threadCount, Fn&& fn)
+{
+	if(threadCount > count)
+		threadCount = static_cast<unsigned>(count);
+	if(threadCount <= 1)
+	{
+		fn(size_t(0), count);
+		return;
+	}
+
+	size_t band = count / threadCount;
+	size_t remainder = count % threadCount;
+
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount - 1);
+
+	size_t firstEnd = band + (remainder > 0 ? 1 : 0);
+	size_t begin = firstEnd;
+	for(unsigned t = 1; t < threadCount; t++)
+	{
+		size_t end = begin + band + (t < remainder ? 1 : 0);
+		workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+		begin = end;
+	}
+
+	fn(size_t(0), firstEnd);
+	for(std::thread& worker : workers)
+		worker.join();
+}
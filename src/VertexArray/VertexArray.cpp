@@ -0,0 +1,216 @@
+#include "VertexArray.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+static GLenum glPrimitive(PrimitiveMode mode)
+{
+	return mode == PrimitiveMode::TriangleStrip ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+}
+
+static GLenum glAttributeType(AttributeType type)
+{
+	switch(type)
+	{
+	case AttributeType::Int16: return GL_SHORT;
+	case AttributeType::UInt16: return GL_UNSIGNED_SHORT;
+	case AttributeType::HalfFloat: return GL_HALF_FLOAT;
+	default: return GL_FLOAT;
+	}
+}
+
+// Points attribute at the bound GL_ARRAY_BUFFER, starting firstVertex vertices in
+static void setAttributePointer(const VertexAttribute& attribute, size_t firstVertex)
+{
+	glVertexAttribPointer(attribute.location, attribute.components, glAttributeType(attribute.type),
+						  attribute.normalized ? GL_TRUE : GL_FALSE, static_cast<int>(attribute.stride),
+						  reinterpret_cast<const void*>(attribute.offset + firstVertex * attribute.stride));
+	glEnableVertexAttribArray(attribute.location);
+}
+
+// Whole triangles, so a list too long for one GLsizei count can be drawn in pieces
+static const size_t maxDrawIndices = INT_MAX / 3 * 3;
+
+VertexArray::VertexArray(const VertexAttribute* attributes, size_t attributeCount,
+						 const Span<unsigned char>* vertexData, size_t vertexBufferCount,
+						 Span<unsigned int> indices, PrimitiveMode primitive)
+	: bufferCount(vertexBufferCount), indexCount(indices.size),
+	  indexType(GL_UNSIGNED_INT), indexSize(sizeof(unsigned int)), primitive(primitive)
+{
+	create(attributes, attributeCount, vertexData, indices.data, indices.bytes());
+}
+
+VertexArray::VertexArray(const VertexAttribute* attributes, size_t attributeCount,
+						 const Span<unsigned char>* vertexData, size_t vertexBufferCount,
+						 Span<uint16_t> indices, PrimitiveMode primitive)
+	: bufferCount(vertexBufferCount), indexCount(indices.size),
+	  indexType(GL_UNSIGNED_SHORT), indexSize(sizeof(uint16_t)), primitive(primitive)
+{
+	create(attributes, attributeCount, vertexData, indices.data, indices.bytes());
+}
+
+void VertexArray::create(const VertexAttribute* attributes, size_t attributeCount,
+						 const Span<unsigned char>* vertexData, const void* indexData, size_t indexBytes)
+{
+	size_t vertexCount = 0;
+	for(size_t a = 0; a < attributeCount; a++)
+		vertexCount = std::max(vertexCount, vertexData[attributes[a].buffer].bytes() / attributes[a].stride);
+	vaos.resize(std::max<size_t>((vertexCount + segmentVertices - 1) / segmentVertices, 1));
+	glGenVertexArrays(static_cast<int>(vaos.size()), vaos.data());
+
+	if(primitive == PrimitiveMode::TriangleStrip && indexCount > INT_MAX)
+		std::cout << "Too many strip indices for one draw call, use TerrainTiler instead" << std::endl;
+
+	// Vertex buffers
+	glGenBuffers(static_cast<int>(bufferCount), buffers);
+	for(size_t b = 0; b < bufferCount; b++)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[b]);
+		glBufferData(GL_ARRAY_BUFFER, vertexData[b].bytes(), vertexData[b].data, GL_STATIC_DRAW);
+	}
+
+	// Indices
+	glGenBuffers(1, &ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indexData, GL_STATIC_DRAW);
+
+	// Every segment reads the same buffers from its own first vertex on
+	for(size_t segment = 0; segment < vaos.size(); segment++)
+	{
+		glBindVertexArray(vaos[segment]);
+		for(size_t b = 0; b < bufferCount; b++)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[b]);
+			for(size_t a = 0; a < attributeCount; a++)
+			{
+				if(attributes[a].buffer == b)
+					setAttributePointer(attributes[a], segment * segmentVertices);
+			}
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	}
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void VertexArray::addVertexBuffer(const VertexAttribute* attributes, size_t attributeCount, const void* data, size_t bytes)
+{
+	glGenBuffers(1, &extraBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, extraBuffer);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), data, GL_STATIC_DRAW);
+
+	for(size_t segment = 0; segment < vaos.size(); segment++)
+	{
+		glBindVertexArray(vaos[segment]);
+		for(size_t a = 0; a < attributeCount; a++)
+			setAttributePointer(attributes[a], segment * segmentVertices);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void VertexArray::addInstanceBuffer(const VertexAttribute* attributes, size_t attributeCount)
+{
+	glBindVertexArray(vaos[0]);
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	for(size_t a = 0; a < attributeCount; a++)
+	{
+		setAttributePointer(attributes[a], 0);
+		glVertexAttribDivisor(attributes[a].location, 1);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void VertexArray::setInstances(const void* data, size_t bytes)
+{
+	// Respecifying the whole buffer lets the driver hand out fresh
+	// storage instead of waiting for draws still reading the old one
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), data, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexArray::setIndices(const unsigned int* indices, size_t count)
+{
+	// Orphaned like the instance buffer. The element buffer binding is
+	// part of the VAO, so it's changed with the VAO bound.
+	glBindVertexArray(vaos[0]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(count * sizeof(unsigned int)), indices, GL_STREAM_DRAW);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	indexCount = count;
+}
+
+void VertexArray::bind()
+{
+	glBindVertexArray(vaos[0]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	boundSegment = 0;
+
+	if(primitive == PrimitiveMode::TriangleStrip)
+	{
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(indexType == GL_UNSIGNED_SHORT ? restartIndex<uint16_t>() : restartIndex<unsigned int>());
+	}
+}
+
+void VertexArray::bindSegment(size_t segment)
+{
+	if(segment == boundSegment)
+		return;
+	glBindVertexArray(vaos[segment]);
+	boundSegment = segment;
+}
+
+void VertexArray::unbind()
+{
+	if(primitive == PrimitiveMode::TriangleStrip)
+		glDisable(GL_PRIMITIVE_RESTART);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void VertexArray::draw()
+{
+	// 32-bit indices address every vertex from the first segment, the
+	// count is what can outgrow a single call
+	bindSegment(0);
+	if(primitive == PrimitiveMode::TriangleStrip)
+	{
+		if(indexCount <= INT_MAX)
+			glDrawElements(glPrimitive(primitive), static_cast<int>(indexCount), indexType, nullptr);
+		return;
+	}
+
+	for(size_t first = 0; first < indexCount; first += maxDrawIndices)
+	{
+		size_t count = std::min(indexCount - first, maxDrawIndices);
+		glDrawElements(glPrimitive(primitive), static_cast<int>(count), indexType, reinterpret_cast<const void*>(first * indexSize));
+	}
+}
+
+void VertexArray::drawRange(size_t firstIndex, size_t count, size_t baseVertex)
+{
+	// Ranges are single tiles, far below a GLsizei
+	size_t segment = baseVertex / segmentVertices;
+	bindSegment(segment);
+	glDrawElementsBaseVertex(glPrimitive(primitive), static_cast<int>(count), indexType,
+							 reinterpret_cast<const void*>(firstIndex * indexSize),
+							 static_cast<int>(baseVertex - segment * segmentVertices));
+}
+
+void VertexArray::drawInstanced(size_t instanceCount)
+{
+	glDrawElementsInstanced(glPrimitive(primitive), static_cast<int>(indexCount), indexType, nullptr, static_cast<int>(instanceCount));
+}
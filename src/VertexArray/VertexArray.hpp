@@ -0,0 +1,81 @@
+#pragma once
+#include "../Terrain/VertexLayout.hpp"
+#include "../Terrain/TerrainTiler.hpp"
+#include <vector>
+
+// A VAO with its vertex buffers and index buffer, set up from attribute
+// descriptions. The base vertex of a draw is a GLint, so meshes with more
+// vertices get one VAO per segmentVertices vertices, each pointing its
+// attributes further into the same buffers, and drawRange() picks the one
+// that keeps the base vertex small.
+struct VertexArray
+{
+	static constexpr size_t segmentVertices = size_t(1) << 30;
+
+	std::vector<unsigned int> vaos;
+	unsigned int ebo;
+	unsigned int buffers[4];
+	size_t bufferCount;
+	unsigned int instanceBuffer = 0;
+	unsigned int extraBuffer = 0;
+	size_t indexCount;
+	unsigned int indexType;	// GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+	size_t indexSize;
+	PrimitiveMode primitive;
+
+	VertexArray(const VertexAttribute* attributes, size_t attributeCount,
+				const Span<unsigned char>* vertexData, size_t vertexBufferCount,
+				Span<unsigned int> indices, PrimitiveMode primitive);
+
+	VertexArray(const VertexAttribute* attributes, size_t attributeCount,
+				const Span<unsigned char>* vertexData, size_t vertexBufferCount,
+				Span<uint16_t> indices, PrimitiveMode primitive);
+
+	template<typename Layout>
+	explicit VertexArray(const LayoutMeshView<Layout>& mesh)
+		: VertexArray(Layout::attributes().data(), Layout::attributeCount,
+					  mesh.buffers, Layout::bufferCount, mesh.indices, mesh.primitive)
+	{
+		static_assert(Layout::bufferCount <= 4, "VertexArray holds at most 4 vertex buffers");
+	}
+
+	// All tiles share the vertex and index buffers, draw them with drawRange()
+	template<typename Layout>
+	explicit VertexArray(const TiledMeshView<Layout>& mesh)
+		: VertexArray(Layout::attributes().data(), Layout::attributeCount,
+					  mesh.buffers, Layout::bufferCount, mesh.indices, mesh.primitive)
+	{
+		static_assert(Layout::bufferCount <= 4, "VertexArray holds at most 4 vertex buffers");
+	}
+
+	// Strips also turn on primitive restart for the index type
+	void bind();
+	void unbind();
+	void draw();
+
+	// Draws count indices starting at firstIndex, offset by baseVertex, with
+	// the VAO of baseVertex's segment. Call between bind() and unbind().
+	void drawRange(size_t firstIndex, size_t count, size_t baseVertex);
+
+	// Adds a static buffer of per-vertex attributes that the vertex format
+	// doesn't describe, such as morph targets
+	void addVertexBuffer(const VertexAttribute* attributes, size_t attributeCount, const void* data, size_t bytes);
+
+	// Adds a buffer of attributes that advance once per instance instead of
+	// once per vertex. Its contents are streamed in with setInstances().
+	void addInstanceBuffer(const VertexAttribute* attributes, size_t attributeCount);
+	void setInstances(const void* data, size_t bytes);
+
+	// Replaces the 32-bit indices, for meshes that are retriangulated every frame
+	void setIndices(const unsigned int* indices, size_t count);
+
+	// Draws all indices once per instance, meshes with a single segment only
+	void drawInstanced(size_t instanceCount);
+
+private:
+	size_t boundSegment = 0;
+
+	void create(const VertexAttribute* attributes, size_t attributeCount,
+				const Span<unsigned char>* vertexData, const void* indexData, size_t indexBytes);
+	void bindSegment(size_t segment);
+};
@@ -3,18 +3,194 @@
 
 #include <vector>
 #include <iostream>
+#include <optional>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "RM/ResourceManagement.hpp"
+#include "Terrain/TerrainMesh.hpp"
+#include "Terrain/Arena.hpp"
+#include "Terrain/VertexLayout.hpp"
+#include "Terrain/TerrainTiler.hpp"
+#include "Terrain/Rtin.hpp"
+#include "Terrain/GreedyTin.hpp"
+#include "Terrain/ChunkedLod.hpp"
+#include "Terrain/LodScheduler.hpp"
+#include "Terrain/MeshCache.hpp"
+#include "Terrain/Cdlod.hpp"
+#include "Terrain/GeometryClipmap.hpp"
+#include "Terrain/Roam.hpp"
+#include "Terrain/VertexCacheOptimizer.hpp"
+#include "VertexArray/VertexArray.hpp"
+#include "Util/AllocCounter.hpp"
+#include "Util/Parallel.hpp"
 
 const int WIDTH = 1280;
 const int HEIGHT = 720;
 
+// Vertex format of the terrain mesh, any of the layouts in
+// Terrain/VertexLayout.hpp works. The mesh, the VAO and the
+// shader variant are all generated from it.
+using TerrainLayout = SoALayout;
+
+// Triangle lists or serpentine triangle strips with primitive restart
+const PrimitiveMode TERRAIN_PRIMITIVE = PrimitiveMode::Triangles;
+
+// Post-transform cache size the triangle lists are optimized for, 0 to skip
+const int VERTEX_CACHE_SIZE = 32;
+
+// The full grid, or an adaptive mesh leaving out the corners that are
+// within ADAPTIVE_MAX_ERROR of it, in heightmap units of [0, 1]
+enum class TerrainMesher
+{
+	Grid,
+	Rtin,		// Fast, but square power-of-two heightmaps only
+	GreedyTin	// Fewest triangles for the error
+};
+
+const TerrainMesher TERRAIN_MESHER = TerrainMesher::Grid;
+const float ADAPTIVE_MAX_ERROR = 0.002f;
+
+// One static mesh, a chunked LOD quadtree that is refined each frame
+// until the chunks drawn are within LOD_PIXEL_ERROR pixels of the full grid,
+// CDLOD, which instances one small patch and morphs it between levels
+// in the vertex shader, a geometry clipmap of nested grids around the
+// camera, or a ROAM mesh that is split and merged each frame to stay within
+// ROAM_TRIANGLE_BUDGET. CDLOD and the clipmap ignore the mesher and vertex
+// layout, ROAM needs a square power-of-two heightmap.
+enum class TerrainRenderer
+{
+	Static,
+	ChunkedLod,
+	Cdlod,
+	Clipmap,
+	Roam
+};
+
+const TerrainRenderer TERRAIN_RENDERER = TerrainRenderer::Static;
+const float LOD_PIXEL_ERROR = 2.0f;
+const size_t ROAM_TRIANGLE_BUDGET = 65536;
+
+// Chunked LOD picks the chunks that fit this many triangles each frame
+// instead of refining to LOD_PIXEL_ERROR, 0 for no budget
+const size_t CHUNK_TRIANGLE_BUDGET = 0;
+
+// How chunks of different levels meet, see Terrain/LodSeams.hpp
+const SeamMode CHUNK_SEAMS = SeamMode::Stitching;
+
+// Chunks blend towards their parent's surface before they're merged into
+// it and after they replace it, so switching levels doesn't pop
+const bool CHUNK_GEOMORPH = true;
+
+// The grid and chunked meshes are saved here once built and mapped back
+// on the next run, as long as the heights and mesh parameters match
+const bool USE_MESH_CACHE = true;
+const char* const GRID_MESH_CACHE = "grid.meshcache";
+const char* const CHUNKED_MESH_CACHE = "chunked.meshcache";
+
+// The clipmap samples its levels from this tiled heightmap of the same size
+// through a cache of CLIPMAP_CACHE_TILES tiles instead of the heightmap's
+// CPU copy, nullptr for the CPU copy
+const char* const CLIPMAP_TILED_HEIGHTMAP = nullptr;
+const size_t CLIPMAP_CACHE_TILES = 64;
+
+// Vertex format of the CDLOD and clipmap patches, which the vertex shader places
+using LodPatchLayout = GridOnlyLayout;
+
+// A static or chunked terrain mesh ready to upload, in the arena it was
+// built in or the cache file it was mapped from. Adaptive meshes are
+// small enough for 32-bit indices, so they are a single tile instead.
+struct PreparedTerrainMesh
+{
+	MappedFile cached;
+	Arena arena;
+	TiledMeshView<TerrainLayout> mesh;
+	LayoutMeshView<TerrainLayout> adaptiveMesh;
+	TerrainTile adaptiveTile = {};
+};
+
 void processInput(GLFWwindow* window, float& scale);
+std::unique_ptr<PreparedTerrainMesh> prepareGridTerrain(const TerrainTiler& tiler);
+std::unique_ptr<PreparedTerrainMesh> prepareChunkedTerrain(const TerrainTiler& tiler, const HeightGrid& heights, ChunkedLod& lod);
+std::unique_ptr<PreparedTerrainMesh> prepareAdaptiveTerrain(const TerrainMeshBuilder& grid, const HeightGrid& heights);
+VertexArray uploadTerrain(const PreparedTerrainMesh& prepared, std::vector<TerrainTile>& tiles);
+VertexArray createCdlodTerrain(const HeightGrid& heights, Cdlod& cdlod);
+VertexArray createClipmapTerrain(const HeightGrid& heights, TiledHeightfieldReader& tiledHeights, GeometryClipmap& clipmap,
+								 std::vector<TerrainTile>& variants);
+VertexArray createRoamTerrain(const TerrainMeshBuilder& grid, Roam& roam);
 
 int main() {
+	bool chunked = TERRAIN_RENDERER == TerrainRenderer::ChunkedLod;
+	bool cdlodMode = TERRAIN_RENDERER == TerrainRenderer::Cdlod;
+	bool clipmapMode = TERRAIN_RENDERER == TerrainRenderer::Clipmap;
+	bool roamMode = TERRAIN_RENDERER == TerrainRenderer::Roam;
+	bool patchMode = cdlodMode || clipmapMode;
+
+	// Shaders
+	std::vector<std::string> shaderDefines = patchMode ? LodPatchLayout::shaderDefines() : TerrainLayout::shaderDefines();
+	if(cdlodMode)
+		shaderDefines.push_back("CDLOD");
+	if(clipmapMode)
+		shaderDefines.push_back("CLIPMAP");
+	if(chunked && CHUNK_GEOMORPH)
+		shaderDefines.push_back("GEOMORPH");
+
+	// Formats with baked heights, the adaptive meshers and the LOD renderers need a CPU copy of the heightmap
+	bool bakeHeights = TerrainLayout::has<AttributeRole::Height> && !patchMode;
+	bool adaptive = TERRAIN_MESHER != TerrainMesher::Grid && TERRAIN_RENDERER == TerrainRenderer::Static;
+	bool needHeights = bakeHeights || adaptive || chunked || patchMode || roamMode;
+
+	// Shader files are read and the heightmap decoded on worker threads while
+	// the window opens, only the GL objects are created on this thread
+	std::future<RM::ShaderSources> shaderSources = RM::readShadersAsync("../image-to-terrain/res/shaders/basicV.glsl",
+																		"../image-to-terrain/res/shaders/basicF.glsl",
+																		shaderDefines);
+	std::future<RM::HeightmapData> heightmapData = RM::prepareHeightmapAsync("../image-to-terrain/res/images/noise.png", needHeights);
+
+	// The static grid or chunk meshes are built, or read from their cache,
+	// right after the heightmap is decoded. Until terrainMesh is ready only
+	// its worker touches the heightmap, tiler, quadtree and mode flags.
+	RM::HeightmapData heightmapSource;
+	HeightGrid heights;
+	TerrainTiler tiler(0, 0);
+	ChunkedLod lod;
+	std::future<std::unique_ptr<PreparedTerrainMesh>> terrainMesh = std::async(std::launch::async, [&]
+	{
+		heightmapSource = heightmapData.get();
+		heights = std::move(heightmapSource.heights);
+		int width = heightmapSource.view.width;
+		int height = heightmapSource.view.height;
+
+		if(TERRAIN_MESHER == TerrainMesher::Rtin && !Rtin::supports(width, height))
+		{
+			std::cout << "RTIN needs a square power-of-two heightmap, drawing the full grid instead" << std::endl;
+			adaptive = false;
+		}
+		if(roamMode && !Roam::supports(width, height))
+		{
+			std::cout << "ROAM needs a square power-of-two heightmap, drawing the full grid instead" << std::endl;
+			roamMode = false;
+		}
+
+		tiler = TerrainTiler(width, height);
+		tiler.grid.threadCount = defaultThreadCount();
+		tiler.grid.primitive = TERRAIN_PRIMITIVE;
+		tiler.vertexCacheSize = VERTEX_CACHE_SIZE;
+		tiler.grid.heights = bakeHeights || chunked ? &heights : nullptr;
+
+		std::unique_ptr<PreparedTerrainMesh> mesh;
+		if(chunked)
+			mesh = prepareChunkedTerrain(tiler, heights, lod);
+		else if(!roamMode && !patchMode)
+			mesh = adaptive ? prepareAdaptiveTerrain(tiler.grid, heights) : prepareGridTerrain(tiler);
+		return mesh;
+	});
+
 	// GLFW init
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -37,93 +213,54 @@ int main() {
 	glViewport(0, 0, WIDTH, HEIGHT);
 	glEnable(GL_DEPTH_TEST);
 
-	// Shaders
-    Shader basicShader = RM::loadShaders("../image-to-terrain/res/shaders/basicV.glsl",
-                                         "../image-to-terrain/res/shaders/basicF.glsl");
+	// Keep the window responsive until the workers are done
+	auto ready = [](const auto& future) { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+	while(!ready(shaderSources) || !ready(terrainMesh))
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+    Shader basicShader = RM::createShader(shaderSources.get());
+	std::unique_ptr<PreparedTerrainMesh> preparedMesh = terrainMesh.get();
 
 	// Texture loading
-    Texture heightmap = RM::loadTexture("../image-to-terrain/res/images/noise.png");
+    Texture heightmap = RM::uploadHeightmap(heightmapSource);
+	heightmapSource = RM::HeightmapData();	// The texture has its own copy of the samples
 
     int tWidth = heightmap.width;
     int tHeight = heightmap.height;
 
-    size_t tArea = static_cast<size_t>(tWidth * tHeight);
-
-	std::vector<float> vPos;
-    vPos.reserve(tArea * 12);
-
-	std::vector<unsigned int> indices;
-    indices.reserve(tArea * 6);
-
-	std::vector<float> texPos;
-    texPos.reserve(tArea * 8);
-
-	unsigned int index = 0;
 	float scale = 10.0f;
-    for(float i = 0; i < tWidth; i++)
-    for(float j = 0; j < tHeight; j++)
-	{
-		std::vector<float> currentVPos
-		{
-            i, 0.0f, j,
-            i + 1.0f, 0.0f, j,
-            i + 1.0f, 0.0f, j + 1.0f,
-            i, 0.0f, j + 1.0f,
-		};
-
-		vPos.insert(vPos.end(), currentVPos.begin(), currentVPos.end());
-
-		std::vector<unsigned int> currentIndices
-		{
-			index, index + 1, index + 2,
-			index + 2, index + 3, index
-		};
 
-		indices.insert(indices.end(), currentIndices.begin(), currentIndices.end());
-		index += 4;
-
-		std::vector<float> currentTexCoordinates
-		{
-            i / tWidth, j / tHeight,
-            (i+1) / tWidth, j / tHeight,
-            (i+1) / tWidth, (j+1) / tHeight,
-            i / tWidth, (j+1) / tHeight
-		};
-
-		texPos.insert(texPos.end(), currentTexCoordinates.begin(), currentTexCoordinates.end());
-	}
-
-	// VAO creation
-	unsigned int VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
-
-	// Vertex coordinates
-	unsigned int VBO, EBO, tVBO;
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vPos.size() * sizeof(float), vPos.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
-	glEnableVertexAttribArray(0);
-
-	// Indices
-	glGenBuffers(1, &EBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-	// Texture coordinates
-	glGenBuffers(1, &tVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, tVBO);
-	glBufferData(GL_ARRAY_BUFFER, texPos.size() * sizeof(float), texPos.data(), GL_STATIC_DRAW);
-	
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-	glEnableVertexAttribArray(1);
-
-	// Clean up
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	// VAO creation, every mesh but CDLOD's instanced patch is drawn as a list
+	// of tiles. The clipmap's tiles are the index variants of its levels.
+	std::vector<TerrainTile> tiles;
+	Cdlod cdlod;
+	TiledHeightfieldReader tiledHeights;
+	GeometryClipmap clipmap;
+	std::optional<Roam> roam;
+	if(roamMode)
+		roam.emplace(heights);
+	VertexArray terrain = preparedMesh ? uploadTerrain(*preparedMesh, tiles) :
+						  roamMode ? createRoamTerrain(tiler.grid, *roam) :
+						  cdlodMode ? createCdlodTerrain(heights, cdlod) :
+						  createClipmapTerrain(heights, tiledHeights, clipmap, tiles);
+	preparedMesh.reset();	// The buffers have their own copy of the mesh
+
+	// The LOD renderers draw what they select for the frame's camera
+	std::vector<uint32_t> visibleChunks;
+	std::vector<uint8_t> seamMasks;
+	std::vector<float> morphs;
+	LodScheduler scheduler;
+	scheduler.budget = CHUNK_TRIANGLE_BUDGET;
+	std::vector<CdlodInstance> instances;
+	std::vector<unsigned int> roamIndices;
+	LodCamera lodCamera;
+	lodCamera.verticalFov = glm::radians(45.0f);
+	lodCamera.viewportHeight = static_cast<float>(HEIGHT);
 
 	basicShader.use();
 	basicShader.setInt(glGetUniformLocation(basicShader.program, "tex"), 0);
@@ -132,12 +269,24 @@ int main() {
 	int projectionLoc = glGetUniformLocation(basicShader.program, "projection");
 	int viewLoc = glGetUniformLocation(basicShader.program, "view");
 	int scaleLoc = glGetUniformLocation(basicShader.program, "scale");
+	int cameraPositionLoc = glGetUniformLocation(basicShader.program, "cameraPosition");
+	int morphLoc = glGetUniformLocation(basicShader.program, "morph");
+	int clipLevelLoc = glGetUniformLocation(basicShader.program, "clipLevel");
+	int clipOriginLoc = glGetUniformLocation(basicShader.program, "clipOrigin");
+	basicShader.setVec2(glGetUniformLocation(basicShader.program, "gridSize"), glm::vec2(tWidth, tHeight));
+
+	// The clipmap's levels are streamed into layers of a texture array
+	std::optional<HeightTextureArray> clipmapHeights;
+	if(clipmapMode)
+	{
+		clipmapHeights.emplace(heightmap.index + 1, clipmap.samples(), clipmap.samples(), static_cast<int>(clipmap.levels.size()));
+		basicShader.setInt(glGetUniformLocation(basicShader.program, "clipmap"), clipmapHeights->index);
+		basicShader.setInt(glGetUniformLocation(basicShader.program, "clipSamples"), clipmap.samples());
+	}
 
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(WIDTH) / static_cast<float>(HEIGHT), 0.1f, 1500.0f);
 	basicShader.setMat4(projectionLoc, projection);
 
-    int vertexCount = static_cast<int>(indices.size());
-
 	while(!glfwWindowShouldClose(window)) {
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -153,13 +302,89 @@ int main() {
 
 		heightmap.bind();
 
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-
-        glDrawElements(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, nullptr);
+		// The camera in terrain space, where the LOD quadtrees' bounds are
+		glm::vec4 camera = glm::inverse(view * model) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		lodCamera.position[0] = camera.x;
+		lodCamera.position[1] = camera.y;
+		lodCamera.position[2] = camera.z;
+		lodCamera.heightScale = scale;
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		terrain.bind();
+		if(chunked)
+		{
+			// Each chunk draws the stitching variant that matches its coarser
+			// neighbours, blended towards its parent by a single uniform. The
+			// scheduler's chunks are restricted already, within the budget, and
+			// blend over the error its refinement stopped at.
+			float morphError = LOD_PIXEL_ERROR;
+			if(CHUNK_TRIANGLE_BUDGET > 0)
+			{
+				LodScheduleStats scheduled = scheduler.schedule(lod, lodCamera, visibleChunks);
+				if(scheduled.pixelErrorReached > 0.0f)
+					morphError = scheduled.pixelErrorReached;
+			}
+			else
+			{
+				lod.select(lodCamera, LOD_PIXEL_ERROR, visibleChunks);
+			}
+			if(lod.seams == SeamMode::Stitching)
+				lod.restrictSelection(visibleChunks, seamMasks);
+			else
+				seamMasks.assign(visibleChunks.size(), 0);
+			if(lod.geomorph)
+				lod.morphFactors(lodCamera, morphError, visibleChunks, morphs);
+
+			for(size_t k = 0; k < visibleChunks.size(); k++)
+			{
+				if(lod.geomorph)
+					basicShader.setFloat(morphLoc, morphs[k]);
+
+				const TerrainTile& tile = tiles[visibleChunks[k] * lod.tilesPerChunk() + seamMasks[k]];
+				terrain.drawRange(tile.firstIndex, tile.indexCount, tile.baseVertex);
+			}
+		}
+		else if(cdlodMode)
+		{
+			cdlod.select(lodCamera, instances);
+			basicShader.setVec3(cameraPositionLoc, glm::vec3(camera.x, camera.y, camera.z));
+			terrain.setInstances(instances.data(), instances.size() * sizeof(CdlodInstance));
+			terrain.drawInstanced(instances.size());
+		}
+		else if(clipmapMode)
+		{
+			// Only the strips that came into view are sampled and uploaded
+			clipmap.update(camera.x, camera.z);
+			for(const ClipmapRegion& region : clipmap.updated)
+				clipmapHeights->update(region.level, region.firstColumn, region.firstRow, region.columns, region.rows,
+									   clipmap.levels[region.level].heights.data());
+
+			clipmapHeights->bind();
+			for(int l = 0; l < static_cast<int>(clipmap.levels.size()); l++)
+			{
+				const ClipmapLevel& level = clipmap.levels[l];
+				basicShader.setInt(clipLevelLoc, l);
+				basicShader.setIVec2(clipOriginLoc, glm::ivec2(level.originRow, level.originColumn));
+
+				const TerrainTile& variant = tiles[clipmap.indexVariantOf(l)];
+				terrain.drawRange(variant.firstIndex, variant.indexCount, 0);
+			}
+			clipmapHeights->unbind();
+		}
+		else if(roamMode)
+		{
+			// The mesh carries over from the last frame, only what the camera's
+			// motion changed is split or merged before the indices are streamed
+			roam->update(lodCamera);
+			roam->writeIndices(roamIndices);
+			terrain.setIndices(roamIndices.data(), roamIndices.size());
+			terrain.draw();
+		}
+		else
+		{
+			for(const TerrainTile& tile : tiles)
+				terrain.drawRange(tile.firstIndex, tile.indexCount, tile.baseVertex);
+		}
+		terrain.unbind();
 
 		heightmap.unbind();
 
@@ -171,6 +396,189 @@ int main() {
 	return 0;
 }
 
+// Mesh generation writes straight into arena memory, which is only
+// needed until the buffers are uploaded. The terrain is cut into
+// 16-bit indexed tiles, so any heightmap size can be meshed. A mesh
+// cache from an earlier run is uploaded straight from its mapping.
+std::unique_ptr<PreparedTerrainMesh> prepareGridTerrain(const TerrainTiler& tiler)
+{
+	auto prepared = std::make_unique<PreparedTerrainMesh>();
+	uint64_t cacheKey = meshCacheKey<TerrainLayout>(tiler);
+	if(USE_MESH_CACHE && loadMeshCache(GRID_MESH_CACHE, cacheKey, prepared->cached, prepared->mesh))
+	{
+		std::cout << "Loaded the terrain mesh from " << GRID_MESH_CACHE << std::endl;
+	}
+	else
+	{
+		prepared->arena.reserve(tiledArenaBytes<TerrainLayout>(tiler));
+		{
+			AllocCounter::Scope allocScope("mesh generation");
+			prepared->mesh = buildTiledMesh<TerrainLayout>(tiler, prepared->arena);
+		}
+		if(USE_MESH_CACHE && !saveMeshCache(GRID_MESH_CACHE, cacheKey, prepared->mesh))
+			std::cout << "Failed to write " << GRID_MESH_CACHE << "!" << std::endl;
+	}
+	return prepared;
+}
+
+// Every level of the quadtree gets its own vertices, the indices are
+// shared by all chunks of the same size
+std::unique_ptr<PreparedTerrainMesh> prepareChunkedTerrain(const TerrainTiler& tiler, const HeightGrid& heights, ChunkedLod& lod)
+{
+	lod.chunkCells = std::min(64, tiler.cellsPerTile());
+	lod.threadCount = tiler.grid.threadCount;
+	lod.seams = CHUNK_SEAMS;
+	lod.geomorph = CHUNK_GEOMORPH;
+	lod.build(heights);
+	std::cout << "Chunked LOD: " << lod.chunks.size() << " chunks in " << lod.levelCount << " levels" << std::endl;
+
+	auto prepared = std::make_unique<PreparedTerrainMesh>();
+	uint64_t cacheKey = meshCacheKey<TerrainLayout>(tiler, &lod);
+	if(USE_MESH_CACHE && loadMeshCache(CHUNKED_MESH_CACHE, cacheKey, prepared->cached, prepared->mesh))
+	{
+		std::cout << "Loaded the chunk meshes from " << CHUNKED_MESH_CACHE << std::endl;
+	}
+	else
+	{
+		prepared->arena.reserve(chunkedArenaBytes<TerrainLayout>(tiler, lod));
+		prepared->mesh = buildChunkedMesh<TerrainLayout>(tiler, lod, prepared->arena);
+		if(USE_MESH_CACHE && !saveMeshCache(CHUNKED_MESH_CACHE, cacheKey, prepared->mesh))
+			std::cout << "Failed to write " << CHUNKED_MESH_CACHE << "!" << std::endl;
+	}
+	return prepared;
+}
+
+std::unique_ptr<PreparedTerrainMesh> prepareAdaptiveTerrain(const TerrainMeshBuilder& grid, const HeightGrid& heights)
+{
+	GridTriangulation triangulation;
+	if(TERRAIN_MESHER == TerrainMesher::Rtin)
+	{
+		Rtin rtin(heights);
+		triangulation = rtin.extract(ADAPTIVE_MAX_ERROR);
+	}
+	else
+	{
+		GreedyTin tin(heights);
+		tin.run(ADAPTIVE_MAX_ERROR);
+		triangulation = tin.triangulation();
+	}
+
+	if(VERTEX_CACHE_SIZE > 0)
+		optimizeVertexCache(triangulation.indices.data(), triangulation.indices.size(), triangulation.vertexCount(), VERTEX_CACHE_SIZE);
+	std::cout << "Adaptive mesh: " << triangulation.triangleCount() << " triangles, " << triangulation.vertexCount() << " vertices" << std::endl;
+
+	auto prepared = std::make_unique<PreparedTerrainMesh>();
+	prepared->arena.reserve(triangulationArenaBytes<TerrainLayout>(triangulation));
+	prepared->adaptiveMesh = buildTriangulationMesh<TerrainLayout>(grid, triangulation, prepared->arena);
+	prepared->adaptiveTile.rows = grid.width;
+	prepared->adaptiveTile.columns = grid.height;
+	prepared->adaptiveTile.indexCount = prepared->adaptiveMesh.indices.size;
+	return prepared;
+}
+
+// The GL side of any of them, on the context's thread. Chunks that blend
+// towards their parent carry its positions in an extra vertex buffer.
+VertexArray uploadTerrain(const PreparedTerrainMesh& prepared, std::vector<TerrainTile>& tiles)
+{
+	if(!prepared.adaptiveMesh.indices.empty())
+	{
+		tiles.assign(1, prepared.adaptiveTile);
+		return VertexArray(prepared.adaptiveMesh);
+	}
+
+	const TiledMeshView<TerrainLayout>& mesh = prepared.mesh;
+	VertexArray terrain(mesh);
+	if(!mesh.morphTargets.empty())
+	{
+		VertexAttribute morphTarget = morphTargetAttribute();
+		terrain.addVertexBuffer(&morphTarget, 1, mesh.morphTargets.data, mesh.morphTargets.bytes());
+	}
+	tiles.assign(mesh.tiles.begin(), mesh.tiles.end());
+	return terrain;
+}
+
+// A single patch replaces the whole terrain mesh, so even huge
+// heightmaps only cost the quadtree's height bounds on the CPU
+VertexArray createCdlodTerrain(const HeightGrid& heights, Cdlod& cdlod)
+{
+	cdlod.threadCount = defaultThreadCount();
+	cdlod.build(heights);
+	std::cout << "CDLOD: " << cdlod.nodes.size() << " nodes in " << cdlod.levelCount << " levels" << std::endl;
+
+	TerrainMeshBuilder patch(cdlod.patchCells, cdlod.patchCells);
+	Arena meshArena(layoutArenaBytes<LodPatchLayout>(patch));
+	LayoutMeshView<LodPatchLayout> mesh = buildLayoutMesh<LodPatchLayout>(patch, meshArena);
+	if(VERTEX_CACHE_SIZE > 0)
+		optimizeVertexCache(mesh.indices.data, mesh.indices.size, mesh.vertexCount, VERTEX_CACHE_SIZE);
+
+	VertexArray terrain(mesh);
+	std::array<VertexAttribute, 2> instanceAttributes = cdlodInstanceAttributes();
+	terrain.addInstanceBuffer(instanceAttributes.data(), instanceAttributes.size());
+	return terrain;
+}
+
+// Every level draws the same grid of samples, the finest one whole and
+// the others with a hole where the finer level is
+VertexArray createClipmapTerrain(const HeightGrid& heights, TiledHeightfieldReader& tiledHeights, GeometryClipmap& clipmap,
+								 std::vector<TerrainTile>& variants)
+{
+	if(CLIPMAP_TILED_HEIGHTMAP != nullptr)
+		tiledHeights = RM::openTiledHeightfield(CLIPMAP_TILED_HEIGHTMAP, CLIPMAP_CACHE_TILES);
+	if(CLIPMAP_TILED_HEIGHTMAP != nullptr && tiledHeights.width == heights.width && tiledHeights.height == heights.height)
+	{
+		clipmap.build(tiledHeights);
+	}
+	else
+	{
+		if(CLIPMAP_TILED_HEIGHTMAP != nullptr)
+			std::cout << CLIPMAP_TILED_HEIGHTMAP << " isn't the heightmap's size, sampling its CPU copy instead" << std::endl;
+		clipmap.build(heights);
+	}
+	std::cout << "Geometry clipmap: " << clipmap.levels.size() << " levels of " << clipmap.cells << "x" << clipmap.cells << " cells" << std::endl;
+
+	TerrainMeshBuilder patch(clipmap.cells, clipmap.cells);
+	Arena meshArena(layoutArenaBytes<LodPatchLayout>(patch));
+	LayoutMeshView<LodPatchLayout> mesh = buildLayoutMesh<LodPatchLayout>(patch, meshArena);
+
+	std::vector<unsigned int> indices;
+	for(int v = 0; v < GeometryClipmap::indexVariantCount; v++)
+	{
+		std::vector<unsigned int> variantIndices = clipmap.indexVariant(v);
+		if(VERTEX_CACHE_SIZE > 0)
+			optimizeVertexCache(variantIndices.data(), variantIndices.size(), mesh.vertexCount, VERTEX_CACHE_SIZE);
+
+		TerrainTile variant = {};
+		variant.rows = clipmap.cells;
+		variant.columns = clipmap.cells;
+		variant.firstIndex = indices.size();
+		variant.indexCount = variantIndices.size();
+		variants.push_back(variant);
+		indices.insert(indices.end(), variantIndices.begin(), variantIndices.end());
+	}
+
+	return VertexArray(LodPatchLayout::attributes().data(), LodPatchLayout::attributeCount, mesh.buffers,
+					   LodPatchLayout::bufferCount, { indices.data(), indices.size() }, PrimitiveMode::Triangles);
+}
+
+// The grid's vertices stay put, the ROAM triangles index them directly
+VertexArray createRoamTerrain(const TerrainMeshBuilder& grid, Roam& roam)
+{
+	roam.triangleBudget = ROAM_TRIANGLE_BUDGET;
+	roam.maxPixelError = LOD_PIXEL_ERROR;
+
+	TerrainMeshBuilder vertices = grid;
+	vertices.primitive = PrimitiveMode::Triangles;
+	Arena meshArena(layoutArenaBytes<TerrainLayout>(vertices));
+	LayoutMeshView<TerrainLayout> mesh = buildLayoutMesh<TerrainLayout>(vertices, meshArena);
+	std::cout << "ROAM: " << mesh.vertexCount << " vertices, at most " << roam.triangleBudget << " triangles" << std::endl;
+
+	// The two root triangles until the first frame's update
+	std::vector<unsigned int> indices;
+	roam.writeIndices(indices);
+	return VertexArray(TerrainLayout::attributes().data(), TerrainLayout::attributeCount, mesh.buffers,
+					   TerrainLayout::bufferCount, { indices.data(), indices.size() }, PrimitiveMode::Triangles);
+}
+
 void processInput(GLFWwindow* window, float& scale)
 {
 	if(glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_PRESS)